@@ -2,200 +2,2808 @@
  * @author hongh233
  * @description: This C program will implement a cache module that simulates a cache.
  * The cache I choose is a fully associative cache, and the size of each block is 64 bytes.
- * The cache will work on a fast memory.
+ * The cache will work on a fast memory.  It can also be set-associative (c_info.ways), and be shared by
+ * tenants, with per-tenant statistics and way partitioning, static (way masks) or utility-based (UCP),
+ * and store its blocks compressed (compress.c) or deduplicated, in sets with more tags than lines.
  */
 
 #include "cache.h"
+#include "tinylfu.h"
+#include "compress.h"
+#include "values.h"
 #include <math.h>
+#include <string.h>
+
+#define UCP_SETS 32    // the sets sampled by the shadow tags of each tenant
+#define ASID_SHIFT 26  // the block ids of a 4 GB main memory fit below the ASID in a tag
+#define BIP_EPSILON 32 // BIP inserts one missing block in BIP_EPSILON at the MRU position
+#define DUEL_GROUPS 32 // DIP dedicates one group in DUEL_GROUPS to LRU insertion, and one to BIP
+#define PSEL_MAX 1023  // the policy selector of DIP saturates at 0 and PSEL_MAX
+#define DUEL_ENTRIES 32 // the sampled tag directories of DIP have at least this many entries
+#define RRPV_MAX 7     // Hawkeye ages the lines from 0 (cache-friendly, just used) to RRPV_MAX (cache-averse)
+#define HAWKEYE_SETS 64 // OPTgen of Hawkeye samples at most this many sets, one in HAWKEYE_STRIDE
+#define HAWKEYE_STRIDE 32
+#define HAWKEYE_HISTORY 8 // OPTgen looks back HAWKEYE_HISTORY times the lines of a sampled set
+#define HAWKEYE_REGION 6  // the predictor of Hawkeye is indexed by the region of 2^HAWKEYE_REGION blocks (4 KB)
+
+#define ZCACHE_LEVELS 3       // the replacement walk of a ZCache goes this many levels deep
+#define ZCACHE_CANDIDATES 64  // and collects at most this many replacement candidates
+
+#define FLAG_UCP  1    // the cache base flag of UCP
+#define FLAG_DUEL 2    // the cache base flag of the sampled tag directories of DIP
+#define FLAG_HAWKEYE 4 // the cache base flag of the OPTgen sampler and the predictor of Hawkeye
+#define FLAG_INDEX 8   // the cache base flag of a set index function other than the block id modulo the sets
+#define FLAG_SECTOR 16 // the cache base flag of sectored lines and their byte accounting
+#define FLAG_COMPRESS 32 // the cache base flag of compressed sets
+#define FLAG_DEDUP 64    // the cache base flag of deduplicated sets
+
+static struct cache_counters counters;  // the statistics of the cache and its tenants, outside of the fast memory
+
+#define SEGMENT_BYTES 8  // compressed sets store blocks in segments of this many bytes
+#define LINE_WARMED 2    // the valid bit of a line functional warming filled with its tag only, without its block
 
 /* typedef struct cache_base, represent a cache information part contains metadata and pointer to set array
  * @params: unsigned char initialized: the initialized status represent whether the cache has been initialized
+ * @params: unsigned char warming: set while cache_warm runs, so its work isn't counted in the stats
+ * @params: unsigned char admission: 1 if a TinyLFU filter sits between the cache base and the cache sets
+ * @params: unsigned char tenants: the number of tenants sharing the cache, 0 without tenant accounting
+ * @params: unsigned int seed: the state of the pseudo-random generator used by the random policy
+ * @params: unsigned int validLines: the number of lines that hold a block
+ * @params: unsigned char ways: the lines per set, 0 for a single set of all the lines (fully associative)
+ * @params: unsigned char flags: FLAG_UCP if the ways are partitioned between the tenants by UCP, FLAG_DUEL if
+ *          DIP duels on sampled tag directories that follow the tenant accounting, FLAG_HAWKEYE if the state of
+ *          Hawkeye follows them, FLAG_INDEX if the set index function follows, FLAG_SECTOR if the sector
+ *          accounting follows, FLAG_COMPRESS if the compression accounting comes last and the sets are compressed,
+ *          FLAG_DEDUP if the deduplication accounting comes last and the sets share a pool of data entries
+ * @params: unsigned short psel: the policy selector of DIP, BIP wins above PSEL_MAX / 2
+ * @params: unsigned int numSets: the number of cache sets, 0 if not a single line fits
+ * @params: unsigned int numOfLines: the lines in each set
+ * @params: unsigned int tenantsOffset: where the tenant accounting starts, from the start of the fast memory
+ * @params: unsigned int duelOffset: where the tag directories of DIP start
+ * @params: unsigned int hawkeyeOffset: where the state of Hawkeye starts
+ * @params: unsigned int indexOffset: where the set index function starts
+ * @params: unsigned int sectorOffset: where the sector accounting starts
+ * @params: unsigned int setsOffset: where the cache sets start, the bytes of all the metadata
  * @params: struct cache_set * cacheSetArray: a pointer point to set array
  */
 typedef struct cache_base {
     unsigned char initialized;
+    unsigned char warming;
+    unsigned char admission;
+    unsigned char tenants;
+    unsigned int seed;
+    unsigned int validLines;
+    unsigned char ways;
+    unsigned char flags;
+    unsigned short psel;
+    unsigned int numSets;
+    unsigned int numOfLines;
+    unsigned int tenantsOffset;
+    unsigned int duelOffset;
+    unsigned int hawkeyeOffset;
+    unsigned int indexOffset;
+    unsigned int sectorOffset;
+    unsigned int setsOffset;
     struct cache_set * cacheSetArray;
 } cache_base;
 
 /* typedef struct cache_set, represent a set that contain some lines
  * @params: struct cache_line * cacheLineArray: a pointer point to cache line array
+ * @params: unsigned int mru: the index of the most recently used line (the line with time 0)
  */
 typedef struct cache_set {
     struct cache_line * cacheLineArray;
+    unsigned int mru;
 } cache_set;
 
 /* typedef struct cache_line, represent one element of the line array, contain metadata and blocks
- * @params: unsigned int time: a time counter which used for LRU step
- * @params: unsigned char valid: the valid bit represent whether the line has been used
+ * @params: unsigned int time: a time counter which used for LRU step, with skewed ways the time of the last use
+ * @params: unsigned char valid: the valid bit represent whether the line has been used, LINE_WARMED if warming
+ *          filled it with the tag only and the block isn't loaded yet
+ * @params: unsigned char owner: the tenant that filled the line
+ * @params: unsigned char rrpv: the age of the line for Hawkeye, lines of RRPV_MAX are evicted first
+ * @params: unsigned char sectors: the valid sectors of the line in a sectored cache, one bit each
  * @params: unsigned int tag: the unique identifier for each lines
  * @params: unsigned char cacheBlock[64]: a place where we store data in the cache
  */
 typedef struct cache_line {
     unsigned int time;
     unsigned char valid;
+    unsigned char owner;
+    unsigned char rrpv;
+    unsigned char sectors;
     unsigned int tag;
     unsigned char cacheBlock[64]; // in this architecture, we use 64 bytes in a single block
 } cache_line;
 
+/* typedef struct tenant_state, represent the accounting of one tenant of a shared cache, its statistics are
+ * kept outside of the fast memory with those of the cache
+ * @params: unsigned long long evictedByOthers: the lines of the tenant that another tenant evicted
+ * @params: unsigned int occupancy: the number of lines that hold a block of the tenant
+ * @params: unsigned int wayMask: the ways of a set the tenant may fill
+ * @params: unsigned int umonHits[CACHE_MAX_WAYS]: the hits in the shadow tags at each LRU stack position (UMON)
+ */
+typedef struct tenant_state {
+    unsigned long long evictedByOthers;
+    unsigned int occupancy;
+    unsigned int wayMask;
+    unsigned int umonHits[CACHE_MAX_WAYS];
+} tenant_state;
+
+/* typedef struct tenant_base, represent the tenants of a shared cache, it sits between the TinyLFU filter
+ * and the cache sets, followed with UCP by the shadow tags of each tenant (UCP_SETS sets of ways tags)
+ * @params: unsigned int ucpInterval: the references between two repartitions by UCP
+ * @params: unsigned int accesses: the references since the last repartition
+ * @params: unsigned int partitioned: 1 if some tenant may not fill every way
+ * @params: unsigned int reserved: keeps the tenant states 8 byte aligned
+ * @params: tenant_state tenant[]: the state of each tenant
+ */
+typedef struct tenant_base {
+    unsigned int ucpInterval;
+    unsigned int accesses;
+    unsigned int partitioned;
+    unsigned int reserved;
+    tenant_state tenant[];
+} tenant_base;
+
+/* typedef struct hawkeye_base, represent the state of Hawkeye, it follows the tag directories of DIP. OPTgen
+ * replays the accesses of sampled sets (or, in a fully associative cache, of a sampled share of the blocks,
+ * as a smaller set) and works out which of them Belady's OPT would have hit, which trains the predictor.
+ * The trace has no PCs, so the predictor is indexed by a hash of the address region of the block
+ * @params: unsigned int predictorBits: the predictor has 2^predictorBits 3-bit counters, at least 4 is cache-friendly
+ * @params: unsigned int units: the sampled sets of OPTgen
+ * @params: unsigned int capacity: the lines OPT has in a sampled set
+ * @params: unsigned int window: the accesses of a sampled set OPTgen looks back over
+ * @params: unsigned int share: the sampled share of the 32-bit hash space of the blocks of a fully associative cache
+ * @params: unsigned int reserved: keeps the counters 8 byte aligned
+ * @params: unsigned char counters[]: the counters, then each sampled set: its access count, window occupancy
+ *          counts of OPT, and the window tags of its last accesses, plus 1 so they aren't 0, the top bit set
+ *          once the block was accessed again
+ */
+typedef struct hawkeye_base {
+    unsigned int predictorBits;
+    unsigned int units;
+    unsigned int capacity;
+    unsigned int window;
+    unsigned int share;
+    unsigned int reserved;
+    unsigned char counters[];
+} hawkeye_base;
+
+/* typedef struct index_base, represent the set index function of a set-associative cache, the last of the metadata
+ * @params: unsigned int function: CACHE_INDEX_XOR, CACHE_INDEX_PRIME, CACHE_INDEX_SKEW or CACHE_INDEX_ZCACHE
+ * @params: unsigned int modulus: the largest prime not above the number of sets, for CACHE_INDEX_PRIME
+ * @params: unsigned int bits: the bits of the block id folded onto the set index at a time, for CACHE_INDEX_XOR
+ * @params: unsigned int clock: the accesses so far, the time stamp of the lines of skewed ways
+ * @params: unsigned long long relocations: the blocks a ZCache moved to another way to make room for a fill
+ * @params: unsigned long long candidates: the replacement candidates the walks of a ZCache looked at
+ */
+typedef struct index_base {
+    unsigned int function;
+    unsigned int modulus;
+    unsigned int bits;
+    unsigned int clock;
+    unsigned long long relocations;
+    unsigned long long candidates;
+} index_base;
+
+/* typedef struct sector_base, represent the sectors of a sectored cache and its byte accounting, the last of the
+ * metadata: a line tag covers all the sectors of the block, but each sector has its own valid bit, so a miss
+ * only loads the sectors the access needs
+ * @params: unsigned int sectors: the sectors of a line, 1 to load whole blocks and only count the bytes
+ * @params: unsigned int sectorBytes: the bytes of a sector
+ * @params: unsigned long long fetched: the bytes loaded from main memory
+ * @params: unsigned long long used: the bytes of the 8-byte words referenced of the blocks that left the cache
+ * @params: unsigned char touched[]: for each line, the 8-byte words of its block referenced since it was filled
+ */
+typedef struct sector_base {
+    unsigned int sectors;
+    unsigned int sectorBytes;
+    unsigned long long fetched;
+    unsigned long long used;
+    unsigned char touched[];
+} sector_base;
+
+/* typedef struct compress_base, represent the compression of a compressed cache, the last of the metadata
+ * @params: unsigned int algorithm: CACHE_COMPRESS_BDI, CACHE_COMPRESS_FPC or CACHE_COMPRESS_BEST
+ * @params: unsigned int clock: the accesses so far, the time stamp of the tags
+ * @params: unsigned long long fills: the blocks compressed and stored in a set
+ * @params: unsigned long long bytes: the compressed bytes of those blocks, 64 for a block that doesn't compress
+ */
+typedef struct compress_base {
+    unsigned int algorithm;
+    unsigned int clock;
+    unsigned long long fills;
+    unsigned long long bytes;
+} compress_base;
+
+/* typedef struct compressed_tag, represent one tag of a compressed set, it points at the segments of its block
+ * in the data of the set
+ * @params: unsigned int tag: the unique identifier of the block
+ * @params: unsigned int time: the time stamp of the last use (LRU) or of the fill (FIFO)
+ * @params: unsigned short start: the first segment of the block in the data of the set
+ * @params: unsigned char segments: the segments of the block, 0 for a tag without a block
+ * @params: unsigned char encoding: CACHE_COMPRESS_BDI or CACHE_COMPRESS_FPC for the algorithm the block is
+ *          compressed with, CACHE_COMPRESS_NONE for a block stored as it is
+ */
+typedef struct compressed_tag {
+    unsigned int tag;
+    unsigned int time;
+    unsigned short start;
+    unsigned char segments;
+    unsigned char encoding;
+} compressed_tag;
+
+/* typedef struct compressed_set, represent a set of a compressed cache: twice as many tags as ways, then the data
+ * of the ways, where the blocks of the valid tags are packed from the start, so the free segments are at the end
+ * @params: unsigned int used: the segments of the data that hold blocks
+ * @params: unsigned int reserved: keeps the tags 8 byte aligned
+ * @params: compressed_tag tags[]: the tags, followed by the data
+ */
+typedef struct compressed_set {
+    unsigned int used;
+    unsigned int reserved;
+    compressed_tag tags[];
+} compressed_set;
+
+/* typedef struct dedup_base, represent the deduplication of a deduplicated cache, the last of the metadata.
+ * The sets are followed by the hash buckets of the data entries, then the data entries
+ * @params: unsigned int clock: the accesses so far, the time stamp of the tags
+ * @params: unsigned int hand: the next data entry the CLOCK replacement of the entries looks at
+ * @params: unsigned int freeEntries: the first free data entry, plus 1 so it isn't 0
+ * @params: unsigned int distinct: the data entries in use
+ * @params: unsigned long long fills: the blocks hashed
+ * @params: unsigned long long deduplicated: the blocks an entry already held
+ * @params: unsigned long long probes: the entries of the hash chains looked at
+ * @params: unsigned long long compares: the entries compared byte by byte
+ */
+typedef struct dedup_base {
+    unsigned int clock;
+    unsigned int hand;
+    unsigned int freeEntries;
+    unsigned int distinct;
+    unsigned long long fills;
+    unsigned long long deduplicated;
+    unsigned long long probes;
+    unsigned long long compares;
+} dedup_base;
+
+/* typedef struct dedup_tag, represent one tag of a deduplicated set, each set has twice as many as ways
+ * @params: unsigned int tag: the unique identifier of the block
+ * @params: unsigned int time: the time stamp of the last use (LRU) or of the fill (FIFO)
+ * @params: unsigned int entry: the data entry of the block, plus 1, 0 for a tag without a block
+ * @params: unsigned int sharer: the next tag of all the sets that shares the data entry, plus 1, 0 for the last
+ */
+typedef struct dedup_tag {
+    unsigned int tag;
+    unsigned int time;
+    unsigned int entry;
+    unsigned int sharer;
+} dedup_tag;
+
+/* typedef struct dedup_entry, represent a data entry of a deduplicated cache, shared by the tags of identical blocks
+ * @params: unsigned int hash: the hash of the block
+ * @params: unsigned int next: the next entry of the hash bucket, or of the free entries, plus 1, 0 for the last
+ * @params: unsigned int sharers: the first tag that points at the entry, plus 1
+ * @params: unsigned int refs: the tags that point at the entry, 0 for a free entry
+ * @params: unsigned int referenced: set on a hit, CLOCK passes the entry over once and clears it
+ * @params: unsigned char block[64]: the data of the block
+ */
+typedef struct dedup_entry {
+    unsigned int hash;
+    unsigned int next;
+    unsigned int sharers;
+    unsigned int refs;
+    unsigned int referenced;
+    unsigned char block[64];
+} dedup_entry;
+
+/* typedef struct zcache_candidate, represent a replacement candidate of a ZCache walk
+ * @params: cache_line * line: the line of the candidate
+ * @params: int parent: the candidate whose block would move into this line, -1 for a line of the missing block
+ * @params: unsigned int way: the way of the line
+ */
+typedef struct zcache_candidate {
+    cache_line * line;
+    int parent;
+    unsigned int way;
+} zcache_candidate;
+
+
+/* void function, divide the address into tag and offset, according to the size of the block
+ * @params: unsigned long address: the address that we want to divide
+ * @params: unsigned long * offset: the offset value we want to get
+ * @params: unsigned long * tag: the tag value we want to get
+ * @return: none
+ */
+static void address_decomposer(unsigned long address, unsigned long * offset, unsigned long * tag) {
+
+    // compute the size of a single block (we will not access (cache_line*)0, just for size computation)
+    unsigned int sizeOfBlock = sizeof(((cache_line*)0)->cacheBlock);
+
+    // compute the offsetBit according to the block size
+    unsigned char offsetBit = floor(log2(sizeOfBlock));
+
+    // compute the offset mask to get offset value from address
+    unsigned long offsetMask = ~(0xffffffffffffffff << offsetBit);
+
+    *offset = address & offsetMask; // get the offset value from address
+    *tag = address >> offsetBit;    // right shift to get the tag value from address
+}
+
+
+/* void function, store a numOfElem-length data into valueTemp start from a specified location
+ * @params: unsigned char valueTemp[8]: the value array we will store value into it
+ * @params: unsigned char * block: the source block we want to take value from
+ * @params: unsigned int numOfBlock: the number of elements we want to store into the valueTemp
+ * @params: unsigned int startLocation: the start location where we want to store value to the valueTemp
+ * @return: none
+ */
+static void cache_get_byElem(unsigned char valueTemp[8], const unsigned char * block,
+                             unsigned int numOfElem, unsigned int startLocation) {
+
+    // iteratively store element from block to valueTemp start from startLocation
+    for (int i = 0; i < numOfElem; i++) {
+        valueTemp[i + startLocation] = block[i];
+    }
+}
+
+
+/* unsigned long function, reverse the endian order of an unsigned long value which stored in
+ * an unsigned char array, convert it to an unsigned long value and return
+ * @params: unsigned char valueTemp[8]: the value stored in array which we want to reverse the order
+ * @return: the value with reversed-order endian of the valueTemp
+ */
+static unsigned long reverse_endian(const unsigned char valueTemp[8]) {
+
+    unsigned long value = 0;  // the value we will return, initialize it to 0
+
+    // iteratively move element from valueTemp to the value in reverse endian
+    for (int i = 0; i < 8; i++) {
+        value = (value << 8) | valueTemp[8 - i - 1];
+    }
+    return value;
+}
+
+
+/* unsigned int function, estimate the number of cache lines of a fully associative cache without any
+ * metadata in front of the lines, which sizes the TinyLFU filter
+ * @params: none
+ * @return: the number of cache lines
+ */
+static unsigned int lineEstimate() {
+
+    if (c_info.F_size < sizeof(cache_base) + sizeof(cache_set)) {
+        return 0;
+    }
+    return (c_info.F_size - sizeof(cache_base) - sizeof(cache_set)) / sizeof(cache_line);
+}
+
+
+/* unsigned long function, compute the bytes of the TinyLFU filter, sized for the lines that would fit
+ * in the fast memory without it
+ * @params: unsigned char admission: whether the cache has a filter
+ * @return: the bytes of the filter, 0 without a filter
+ */
+static unsigned long sketchBytes(unsigned char admission) {
+
+    if (!admission) {
+        return 0;
+    }
+    return tinylfu_size(lineEstimate());
+}
+
+
+/* unsigned long function, compute the bytes of the tenant accounting, with UCP the shadow tags included
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the bytes of the tenant accounting, 0 without tenants
+ */
+static unsigned long tenantBytes(cache_base * cacheBase) {
+
+    if (!cacheBase->tenants) {
+        return 0;
+    }
+    unsigned long shadowTags = cacheBase->flags & FLAG_UCP ? UCP_SETS * cacheBase->ways : 0;
+    return sizeof(tenant_base) + cacheBase->tenants * (sizeof(tenant_state) + shadowTags * sizeof(unsigned int));
+}
+
+
+/* unsigned int function, compute the entries of each sampled tag directory of DIP: one line in DUEL_GROUPS,
+ * but at least DUEL_ENTRIES so the sample isn't too noisy, and never more than the lines of the cache
+ * @params: none
+ * @return: the entries of a tag directory
+ */
+static unsigned int duelEntries() {
+
+    unsigned int lines = lineEstimate();
+    unsigned int entries = lines / DUEL_GROUPS > DUEL_ENTRIES ? lines / DUEL_GROUPS : DUEL_ENTRIES;
+    return entries < lines ? entries : (lines ? lines : 1);
+}
+
+
+/* unsigned long function, compute the bytes of the sampled tag directories of DIP
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the bytes of the tag directories, 0 without them
+ */
+static unsigned long duelBytes(cache_base * cacheBase) {
+
+    if (!(cacheBase->flags & FLAG_DUEL)) {
+        return 0;
+    }
+    return (2 + 2 * (unsigned long) duelEntries()) * sizeof(unsigned int);
+}
+
+
+/* void function, size the state of Hawkeye by the lines that would fit without any metadata: a set-associative
+ * cache samples one set in HAWKEYE_STRIDE (at most HAWKEYE_SETS) with its ways, a fully associative cache
+ * samples one block in HAWKEYE_STRIDE as one set of at least 8 lines. The predictor has about a counter per line
+ * @params: unsigned char ways: the lines per set, 0 for a fully associative cache
+ * @params: hawkeye_base * hawkeye: where the sizes are stored, the share included
+ * @return: none
+ */
+static void hawkeyeGeometry(unsigned char ways, hawkeye_base * hawkeye) {
+
+    unsigned int lines = lineEstimate();
+
+    if (ways) {
+        unsigned int sets = lines / ways / HAWKEYE_STRIDE;
+        hawkeye->units = sets < 1 ? 1 : (sets > HAWKEYE_SETS ? HAWKEYE_SETS : sets);
+        hawkeye->capacity = ways;
+        hawkeye->share = 0xffffffffu;
+    } else {
+        unsigned int capacity = lines / HAWKEYE_STRIDE < 8 ? 8 : lines / HAWKEYE_STRIDE;
+        hawkeye->units = 1;
+        hawkeye->capacity = capacity < lines ? (capacity > 255 ? 255 : capacity) : (lines ? lines : 1);
+        hawkeye->share = hawkeye->capacity >= lines ? 0xffffffffu :
+                         (unsigned int) (0x100000000ULL * hawkeye->capacity / lines);
+    }
+    hawkeye->window = HAWKEYE_HISTORY * hawkeye->capacity;
+    for (hawkeye->predictorBits = 6; hawkeye->predictorBits < 12 && (1u << hawkeye->predictorBits) < lines;) {
+        hawkeye->predictorBits++;
+    }
+}
+
+
+/* unsigned long function, compute the bytes of one sampled set of OPTgen: its access count, the occupancy
+ * counts and the tags of its window
+ * @params: const hawkeye_base * hawkeye: the sizes of the state of Hawkeye
+ * @return: the bytes of a sampled set
+ */
+static unsigned long unitBytes(const hawkeye_base * hawkeye) {
+
+    return sizeof(unsigned long long) + (unsigned long) hawkeye->window * (1 + sizeof(unsigned int));
+}
+
+
+/* unsigned long function, compute the bytes of the state of Hawkeye
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the bytes of the predictor and the OPTgen sampler, 0 without them
+ */
+static unsigned long hawkeyeBytes(cache_base * cacheBase) {
+
+    if (!(cacheBase->flags & FLAG_HAWKEYE)) {
+        return 0;
+    }
+    hawkeye_base hawkeye;
+    hawkeyeGeometry(cacheBase->ways, &hawkeye);
+    return sizeof(hawkeye_base) + (1ul << hawkeye.predictorBits) + hawkeye.units * unitBytes(&hawkeye);
+}
+
+
+/* unsigned long function, compute the bytes of the sector accounting, with a touched mask for each of the lines
+ * that would fit without any metadata
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the bytes of the sector accounting, 0 without sectors
+ */
+static unsigned long sectorBytes(cache_base * cacheBase) {
+
+    if (!(cacheBase->flags & FLAG_SECTOR)) {
+        return 0;
+    }
+    return sizeof(sector_base) + ((lineEstimate() + 7ul) & ~7ul);
+}
+
+
+/* unsigned long function, compute the bytes of a set of a compressed cache
+ * @params: unsigned int ways: the ways of the set, it has twice as many tags and the data of as many lines
+ * @return: the bytes of the set
+ */
+static unsigned long compressedSetBytes(unsigned int ways) {
+
+    return sizeof(compressed_set) + 2ul * ways * sizeof(compressed_tag) + ways * (unsigned long) COMPRESS_BLOCK;
+}
+
+
+/* unsigned long function, compute the bytes a set of a deduplicated cache takes, with its share of the data entries
+ * @params: unsigned int ways: the ways of the set, it has twice as many tags and as many data entries and buckets
+ * @return: the bytes of the set
+ */
+static unsigned long dedupSetBytes(unsigned int ways) {
+
+    return 2ul * ways * sizeof(dedup_tag) + ways * (sizeof(dedup_entry) + sizeof(unsigned int));
+}
+
+
+/* void function, lay out the metadata in front of the cache sets and compute the number of cache sets and the
+ * lines in each set, which depend on the size of the fast memory left after the metadata. The metadata is the cache
+ * base, the TinyLFU filter, the tenant accounting, the tag directories, the state of Hawkeye, the set index
+ * function, the sector accounting and the compression or deduplication accounting, in that order. A fully
+ * associative cache has a single set of all the lines, the sets of a compressed or deduplicated cache have the
+ * data of as many lines as ways. The results are stored in the cache base, so an access doesn't redo the sums
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory, its admission, tenants, ways
+ *          and flags set
+ * @return: none
+ */
+static void layout(cache_base * cacheBase) {
+
+    unsigned long offset = sizeof(cache_base) + sketchBytes(cacheBase->admission);
+    cacheBase->tenantsOffset = offset;
+    offset += tenantBytes(cacheBase);
+    cacheBase->duelOffset = offset;
+    offset += duelBytes(cacheBase);
+    cacheBase->hawkeyeOffset = offset;
+    offset += hawkeyeBytes(cacheBase);
+    cacheBase->indexOffset = offset;
+    offset += cacheBase->flags & FLAG_INDEX ? sizeof(index_base) : 0;
+    cacheBase->sectorOffset = offset;
+    offset += sectorBytes(cacheBase);
+    offset += cacheBase->flags & FLAG_COMPRESS ? sizeof(compress_base) : 0;
+    offset += cacheBase->flags & FLAG_DEDUP ? sizeof(dedup_base) : 0;
+    cacheBase->setsOffset = offset;
+
+    unsigned long left = c_info.F_size > offset ? c_info.F_size - offset : 0;
+    if (!cacheBase->ways) {
+        cacheBase->numOfLines = left > sizeof(cache_set) ? (left - sizeof(cache_set)) / sizeof(cache_line) : 0;
+        cacheBase->numSets = cacheBase->numOfLines != 0;
+        return;
+    }
+    cacheBase->numOfLines = cacheBase->ways;
+    if (cacheBase->flags & FLAG_COMPRESS) {
+        cacheBase->numSets = left / compressedSetBytes(cacheBase->ways);
+    } else if (cacheBase->flags & FLAG_DEDUP) {
+        cacheBase->numSets = left / dedupSetBytes(cacheBase->ways);
+    } else {
+        cacheBase->numSets = left / (sizeof(cache_set) + cacheBase->ways * sizeof(cache_line));
+    }
+}
+
+
+/* unsigned int function, get the number of cache sets and the lines in each set, as layout() computed them
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned int * numOfLines: where the number of lines in each set is stored
+ * @return: the number of cache sets, 0 if not a single line fits
+ */
+static unsigned int setCount(cache_base * cacheBase, unsigned int * numOfLines) {
+
+    *numOfLines = cacheBase->numOfLines;
+    return cacheBase->numSets;
+}
+
+
+/* struct tinylfu * function, get the TinyLFU filter, it sits right after the cache base
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the filter, 0 without a filter
+ */
+static struct tinylfu * sketchOf(cache_base * cacheBase) {
+
+    if (!cacheBase->admission) {
+        return 0;
+    }
+    return (struct tinylfu *) ((char *) cacheBase + sizeof(cache_base));
+}
+
+
+/* tenant_base * function, get the tenant accounting, it sits between the TinyLFU filter and the cache sets
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the tenant accounting, 0 without tenants
+ */
+static tenant_base * tenantsOf(cache_base * cacheBase) {
+
+    if (!cacheBase->tenants) {
+        return 0;
+    }
+    return (tenant_base *) ((char *) cacheBase + cacheBase->tenantsOffset);
+}
+
+
+/* unsigned int * function, get the sampled tag directories of DIP, they follow the tenant accounting: the number
+ * of entries of each directory, the share of the hash space they sample, then the tags of the directory with MRU insertion and the tags
+ * of the directory with BIP insertion, both from the most to the least recently used, 0 for an empty entry
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the tag directories, 0 without them
+ */
+static unsigned int * duelOf(cache_base * cacheBase) {
+
+    if (!(cacheBase->flags & FLAG_DUEL)) {
+        return 0;
+    }
+    return (unsigned int *) ((char *) cacheBase + cacheBase->duelOffset);
+}
+
+
+/* hawkeye_base * function, get the state of Hawkeye, it follows the tag directories of DIP
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the state of Hawkeye, 0 without it
+ */
+static hawkeye_base * hawkeyeOf(cache_base * cacheBase) {
+
+    if (!(cacheBase->flags & FLAG_HAWKEYE)) {
+        return 0;
+    }
+    return (hawkeye_base *) ((char *) cacheBase + cacheBase->hawkeyeOffset);
+}
+
+
+/* index_base * function, get the set index function, it follows the state of Hawkeye
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the set index function, 0 for the block id modulo the sets
+ */
+static index_base * indexOf(cache_base * cacheBase) {
+
+    if (!(cacheBase->flags & FLAG_INDEX)) {
+        return 0;
+    }
+    return (index_base *) ((char *) cacheBase + cacheBase->indexOffset);
+}
+
+
+/* sector_base * function, get the sector accounting, it follows the set index function
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the sector accounting, 0 without sectors
+ */
+static sector_base * sectorOf(cache_base * cacheBase) {
+
+    if (!(cacheBase->flags & FLAG_SECTOR)) {
+        return 0;
+    }
+    return (sector_base *) ((char *) cacheBase + cacheBase->sectorOffset);
+}
+
+
+/* compress_base * function, get the compression accounting, it follows the sector accounting
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the compression accounting, 0 without compression
+ */
+static compress_base * compressOf(cache_base * cacheBase) {
+
+    if (!(cacheBase->flags & FLAG_COMPRESS)) {
+        return 0;
+    }
+    return (compress_base *) ((char *) cacheBase + cacheBase->setsOffset - sizeof(compress_base));
+}
+
+
+/* compressed_set * function, get a set of a compressed cache, the sets start where the cache set array would
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned int setIndex: the set
+ * @return: the set
+ */
+static compressed_set * compressedSet(cache_base * cacheBase, unsigned int setIndex) {
+
+    return (compressed_set *) ((char *) cacheBase->cacheSetArray + setIndex * compressedSetBytes(cacheBase->ways));
+}
+
+
+/* dedup_base * function, get the deduplication accounting, it follows the sector accounting
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the deduplication accounting, 0 without deduplication
+ */
+static dedup_base * dedupOf(cache_base * cacheBase) {
+
+    if (!(cacheBase->flags & FLAG_DEDUP)) {
+        return 0;
+    }
+    return (dedup_base *) ((char *) cacheBase + cacheBase->setsOffset - sizeof(dedup_base));
+}
+
+
+/* unsigned int * function, get the hash buckets of a deduplicated cache, they follow the tags of all the sets,
+ * each holds its first data entry plus 1, then come the data entries
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned long lines: the data entries, and the buckets
+ * @return: the hash buckets
+ */
+static unsigned int * bucketsOf(cache_base * cacheBase, unsigned long lines) {
+
+    return (unsigned int *) ((dedup_tag *) cacheBase->cacheSetArray + 2 * lines);
+}
+
+
+/* dedup_entry * function, get the data entries of a deduplicated cache, they follow the hash buckets
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned long lines: the data entries, and the buckets
+ * @return: the data entries
+ */
+static dedup_entry * entriesOf(cache_base * cacheBase, unsigned long lines) {
+
+    return (dedup_entry *) (bucketsOf(cacheBase, lines) + lines);
+}
+
+
+/* unsigned int function, map a block to its set with a hashed set index function, so that power-of-two strides
+ * spread over the sets: XOR folds the higher bits of the block id onto the lower ones before the modulo, prime
+ * takes the block id modulo a prime (the sets above it stay empty)
+ * @params: const index_base * index: the set index function
+ * @params: unsigned long tag: the tag of the block
+ * @params: unsigned int numSets: the number of cache sets
+ * @return: the set of the block
+ */
+static unsigned int hashedSet(const index_base * index, unsigned long tag, unsigned int numSets) {
+
+    if (index->function == CACHE_INDEX_PRIME) {
+        return tag % index->modulus;
+    }
+    return (tag ^ (tag >> index->bits) ^ (tag >> 2 * index->bits)) % numSets;
+}
+
+
+/* unsigned int function, map a block to its set in one way of a skewed-associative cache: every way hashes the
+ * block id with its own odd multiplier, and the top 32 bits of the product scaled to the sets pick the set, so
+ * blocks that conflict in one way rarely conflict in the others
+ * @params: unsigned long tag: the tag of the block
+ * @params: unsigned int way: the way
+ * @params: unsigned int numSets: the number of cache sets
+ * @return: the set of the block in the way
+ */
+static unsigned int skewedSet(unsigned long tag, unsigned int way, unsigned int numSets) {
+
+    unsigned int hash = (unsigned int) tag * (0x9e3779b1u * (2 * way + 1));
+    return (unsigned int) (((unsigned long long) hash * numSets) >> 32);
+}
+
+
+/* unsigned int function, get the tenant of the current reference, an unknown tenant counts as tenant 0
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: the tenant
+ */
+static unsigned int currentTenant(cache_base * cacheBase) {
+
+    return c_info.tenant < cacheBase->tenants ? c_info.tenant : 0;
+}
+
+
+/* unsigned long function, tag a block with the tenant of the current reference (its ASID) if c_info.asid is set,
+ * so the same address of two tenants is two different blocks
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned long tag: the block id
+ * @return: the tag of the block in the cache
+ */
+static unsigned long asidTag(cache_base * cacheBase, unsigned long tag) {
+
+    return c_info.asid ? tag | (unsigned long) currentTenant(cacheBase) << ASID_SHIFT : tag;
+}
+
+
+/* unsigned int function, get the mask of all the ways of a set
+ * @params: unsigned int numOfLines: the number of lines in each set
+ * @return: the mask, all bits set for sets of more than CACHE_MAX_WAYS lines
+ */
+static unsigned int allWays(unsigned int numOfLines) {
+
+    return numOfLines >= CACHE_MAX_WAYS ? ~0u : (1u << numOfLines) - 1;
+}
+
+
+/* unsigned int function, get the ways the tenant of the current reference may fill
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned int numOfLines: the number of lines in each set
+ * @return: the mask of the ways, all the ways without tenants
+ */
+static unsigned int allocationMask(cache_base * cacheBase, unsigned int numOfLines) {
+
+    tenant_base * tenants = tenantsOf(cacheBase);
+    unsigned int mask = tenants ? tenants->tenant[currentTenant(cacheBase)].wayMask & allWays(numOfLines) : 0;
+    return mask ? mask : allWays(numOfLines);
+}
+
+
+/* int function, decide whether a missing block may replace the line the policy picked, the filter
+ * only decides with c_info.admission set to CACHE_ADMISSION_TINYLFU, and an invalid line is always replaced
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned long tag: the tag of the missing block
+ * @params: cache_line * victim: the line the policy picked
+ * @return: 1 to fill the line and 0 to bypass the cache
+ */
+static int admit(cache_base * cacheBase, unsigned long tag, cache_line * victim) {
+
+    struct tinylfu * sketch = sketchOf(cacheBase);
+    if (!sketch || c_info.admission != CACHE_ADMISSION_TINYLFU || !victim->valid) {
+        return 1;
+    }
+    return tinylfu_admit(sketch, tag, victim->tag);
+}
+
+
+/* void function, count a block loaded from main memory past the cache, because the admission filter
+ * rejected it or no line fits in the fast memory, it is a fill that no line keeps. Missing sectors
+ * loaded into a line that already holds the block count the same way
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: none
+ */
+static void count_bypass(cache_base * cacheBase) {
+
+    tenant_base * tenants = tenantsOf(cacheBase);
+
+    if (!cacheBase->warming) {
+        counters.stats.fills++;
+        if (tenants) {
+            counters.tenant[currentTenant(cacheBase)].fills++;
+        }
+    }
+}
+
+
+/* unsigned int function, pick a pseudo-random line index for the random policy (xorshift),
+ * the generator state lives in the cache base so it is saved and forked with the cache
+ * @params: unsigned int numOfLines: the number of lines to pick from
+ * @return: a line index less than numOfLines
+ */
+static unsigned int random_line(unsigned int numOfLines) {
+
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+
+    unsigned int x = cacheBase->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    cacheBase->seed = x;
+
+    return x % numOfLines;
+}
+
+
+/* void function, count a fill of a line: it is an eviction if the line held a block,
+ * otherwise the line becomes valid for the first time. In a shared cache the line changes owner
+ * @params: cache_line * line: the line about to be filled
+ * @return: none
+ */
+static void count_fill(cache_line * line) {
+
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+    tenant_base * tenants = tenantsOf(cacheBase);
+
+    if (!line->valid) {
+        cacheBase->validLines++;
+    }
+    if (!cacheBase->warming) {
+        counters.stats.fills++;
+        counters.stats.evictions += line->valid != 0;
+    }
+
+    if (tenants) {
+        unsigned int tenant = currentTenant(cacheBase);
+        tenant_state * owner = &(tenants->tenant[line->owner]);
+        if (line->valid) {
+            owner->occupancy--;
+            if (line->owner != tenant && !cacheBase->warming) {
+                owner->evictedByOthers++;
+            }
+        }
+        tenants->tenant[tenant].occupancy++;
+        if (!cacheBase->warming) {
+            counters.tenant[tenant].fills++;
+            counters.tenant[tenant].evictions += line->valid != 0;
+        }
+        line->owner = tenant;
+    }
+}
+
+
+/* cache_line * function, pick the line to evict by using the replacement policy in c_info.policy:
+ * LRU and FIFO take the line with the biggest time as evict line, random takes a random line,
+ * both only among the ways in mask
+ * @params: cache_set * set: the reference to our using set
+ * @params: unsigned int numOfLines: the number of lines in the set
+ * @params: unsigned int mask: the ways that may be evicted
+ * @return: the line to evict
+ */
+static cache_line * chooseVictim(cache_set * set, unsigned int numOfLines, unsigned int mask) {
+
+    struct cache_line *evictedLine = set->cacheLineArray;  // the evicted line that we have to find
+
+    // a tenant limited to some of the ways evicts the oldest (or a random) line among them
+    if (mask != allWays(numOfLines)) {
+        unsigned int allowed = 0;  // the number of ways in mask
+        for (int i = 0; i < numOfLines; i++) {
+            allowed += (mask >> i) & 1;
+        }
+        unsigned int pick = c_info.policy == CACHE_POLICY_RANDOM ? random_line(allowed) : 0;
+        evictedLine = 0;
+        for (int i = 0; i < numOfLines; i++) {
+            cache_line * line = &(set->cacheLineArray[i]);
+            if (!((mask >> i) & 1)) {
+                continue;
+            }
+            if (c_info.policy == CACHE_POLICY_RANDOM) {
+                if (pick-- == 0) {
+                    return line;
+                }
+            } else if (!evictedLine || line->time > evictedLine->time) {
+                evictedLine = line;
+            }
+        }
+        return evictedLine;
+    }
+
+    if (c_info.policy == CACHE_POLICY_RANDOM) {
+        evictedLine = &set->cacheLineArray[random_line(numOfLines)];
+    } else {
+        // iteratively find the evicted line with the biggest time
+        for (int i = 0; i < numOfLines; i++) {
+            if (set->cacheLineArray[i].time == (numOfLines - 1)) {
+                evictedLine = &set->cacheLineArray[i];
+            }
+        }
+    }
+    return evictedLine;
+}
+
+
+/* cache_line * function, evict a line picked by chooseVictim: add 1 to the time from all the lines
+ * younger than the evict line, set the time of the evict line to be 0, update the tag with the given tag
+ * @params: cache_set * set: the reference to our using set
+ * @params: cache_line * evictedLine: the line to evict
+ * @params: unsigned long tag: the new tag that we want to assign to the evict line
+ * @params: unsigned int numOfLines: the number of lines in the set
+ * @return: the evicted line
+ */
+static cache_line * replaceLine(cache_set * set, cache_line * evictedLine, unsigned long tag, unsigned int numOfLines) {
+
+    // iteratively add 1 to time from all the other lines
+    for (int i = 0; i < numOfLines; i++) {
+        if (set->cacheLineArray[i].time < evictedLine->time) {
+            set->cacheLineArray[i].time++;
+        }
+    }
+
+    count_fill(evictedLine);
+
+    evictedLine->tag = tag;  // update the tag
+    evictedLine->valid = 1;  // update the valid
+    evictedLine->time = 0;   // set time to 0, which is the most recently used
+
+    set->mru = evictedLine - set->cacheLineArray;  // remember the evicted line as the most recently used
+
+    return evictedLine;
+}
+
+
+/* void function, move a line just filled from the MRU position to the LRU position of the set (LIP/BIP), that
+ * is behind the other valid lines, since the invalid lines must still be filled first: the lines in between
+ * move up one position, and the line that was second becomes the most recently used
+ * @params: cache_set * set: the reference to our using set
+ * @params: cache_line * line: the line that was filled, with time 0
+ * @params: unsigned int numOfLines: the number of lines in the set
+ * @return: none
+ */
+static void demote(cache_set * set, cache_line * line, unsigned int numOfLines) {
+
+    unsigned int position = 0;  // the LRU position among the valid lines, the line itself included
+    for (int i = 0; i < numOfLines; i++) {
+        position += set->cacheLineArray[i].valid != 0;
+    }
+    position--;
+
+    for (int i = 0; i < numOfLines; i++) {
+        cache_line * other = &(set->cacheLineArray[i]);
+        if (other != line && other->time <= position && --other->time == 0) {
+            set->mru = i;
+        }
+    }
+    line->time = position;
+}
+
+
+/* int function, look up a block in a sampled tag directory of DIP and update it like an LRU set: a hit moves
+ * to the MRU position, a miss takes the MRU position, or the LRU position behind the other tags if low is set
+ * @params: unsigned int * tags: the tags of the directory, from the most to the least recently used
+ * @params: unsigned int entries: the number of tags
+ * @params: unsigned int key: the tag of the block, plus 1 so it isn't 0
+ * @params: int low: 1 to insert a missing block at the LRU position
+ * @return: 1 on a miss and 0 on a hit
+ */
+static int duelAccess(unsigned int * tags, unsigned int entries, unsigned int key, int low) {
+
+    unsigned int position = entries - 1;  // the position the block leaves, the last one on a miss
+    for (unsigned int i = 0; i < entries; i++) {
+        if (tags[i] == key || tags[i] == 0) {
+            position = i;
+            break;
+        }
+    }
+    int miss = tags[position] != key;
+    if (miss && low) {
+        tags[position] = key;
+    } else {
+        memmove(tags + 1, tags, position * sizeof(unsigned int));
+        tags[0] = key;
+    }
+    return miss;
+}
+
+
+/* int function, check whether DIP duels on leader sets (set dueling): one set in DUEL_GROUPS always inserts
+ * at the MRU position and one always uses BIP. With too few sets to spare them, DIP duels on two sampled tag
+ * directories instead, that see one block in DUEL_GROUPS, one for each insertion policy
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned int numSets: the number of cache sets
+ * @return: 1 for leader sets and 0 for the tag directories
+ */
+static int leaderSets(cache_base * cacheBase, unsigned int numSets) {
+
+    return numSets >= 2 * DUEL_GROUPS || !duelOf(cacheBase);
+}
+
+
+/* unsigned int function, hash a set or a block to its dueling group, the multiplicative hash spreads strided
+ * sets and blocks over the groups
+ * @params: unsigned long index: the set index or the tag of the block
+ * @return: the group, less than DUEL_GROUPS
+ */
+static unsigned int duelGroup(unsigned long index) {
+
+    return (unsigned int) (index * 0x9e3779b1u) >> 27;
+}
+
+
+/* void function, count an access of a sampled block in the two tag directories of DIP: a miss with MRU insertion
+ * counts the policy selector up, a miss with BIP counts it down. The directories sample the same share of the
+ * blocks as their share of the lines, so they miss like the whole cache would
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned long tag: the tag of the block
+ * @return: none
+ */
+static void sampleDuel(cache_base * cacheBase, unsigned long tag) {
+
+    unsigned int * directories = duelOf(cacheBase);
+    unsigned int entries = directories[0];
+
+    // directories[1] is the sampled share of the 32-bit hash space
+    if ((unsigned int) (tag * 0x9e3779b1u) >= directories[1]) {
+        return;
+    }
+    if (duelAccess(directories + 2, entries, tag + 1, 0)) {
+        cacheBase->psel += cacheBase->psel < PSEL_MAX;
+    }
+    if (duelAccess(directories + 2 + entries, entries, tag + 1, random_line(BIP_EPSILON) != 0)) {
+        cacheBase->psel -= cacheBase->psel > 0;
+    }
+}
+
+
+/* int function, decide whether a missing block is inserted at the LRU position by the insertion policy in
+ * c_info.insertion. DIP takes MRU insertion or BIP as the leader sets or the policy selector say, a miss
+ * in a leader set of MRU insertion counts the selector up, one in a leader set of BIP counts it down
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned int setIndex: the set of the block
+ * @params: unsigned int numSets: the number of cache sets
+ * @return: 1 to insert at the LRU position and 0 to insert at the MRU position
+ */
+static int insertAtLRU(cache_base * cacheBase, unsigned int setIndex, unsigned int numSets) {
+
+    if (c_info.insertion == CACHE_INSERT_LIP) {
+        return 1;
+    }
+    if (c_info.insertion == CACHE_INSERT_DIP) {
+        unsigned int group = leaderSets(cacheBase, numSets) ? duelGroup(setIndex) : DUEL_GROUPS;
+        if (group == 0) {
+            cacheBase->psel += cacheBase->psel < PSEL_MAX;
+            return 0;
+        } else if (group == 1) {
+            cacheBase->psel -= cacheBase->psel > 0;
+        } else if (cacheBase->psel <= PSEL_MAX / 2) {
+            return 0;
+        }
+    }
+    return random_line(BIP_EPSILON) != 0;  // BIP
+}
+
+
+/* unsigned int function, hash the address region of a block to its counter in the predictor of Hawkeye,
+ * the blocks of a region (a page) are predicted alike, as the accesses of one PC would be
+ * @params: const hawkeye_base * hawkeye: the state of Hawkeye
+ * @params: unsigned long tag: the tag of the block
+ * @return: the index of the counter
+ */
+static unsigned int signature(const hawkeye_base * hawkeye, unsigned long tag) {
+
+    return (unsigned int) ((tag >> HAWKEYE_REGION) * 0x9e3779b1u) >> (32 - hawkeye->predictorBits);
+}
+
+
+/* int function, predict whether a block is cache-friendly, every block is without the state of Hawkeye
+ * (c_info.policy was changed to Hawkeye after the cache was initialized)
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned long tag: the tag of the block
+ * @return: 1 if the block is cache-friendly and 0 if it is cache-averse
+ */
+static int friendly(cache_base * cacheBase, unsigned long tag) {
+
+    hawkeye_base * hawkeye = hawkeyeOf(cacheBase);
+    return !hawkeye || hawkeye->counters[signature(hawkeye, tag)] >= 4;
+}
+
+
+/* void function, train the counter of the region of a block towards cache-friendly or cache-averse
+ * @params: hawkeye_base * hawkeye: the state of Hawkeye
+ * @params: unsigned long tag: the tag of the block
+ * @params: int hit: 1 if OPT would have hit the block, 0 if it wouldn't have
+ * @return: none
+ */
+static void train(hawkeye_base * hawkeye, unsigned long tag, int hit) {
+
+    unsigned char * counter = &(hawkeye->counters[signature(hawkeye, tag)]);
+    if (hit) {
+        *counter += *counter < 7;
+    } else {
+        *counter -= *counter > 0;
+    }
+}
+
+
+/* int function, find the sampled set of OPTgen a block belongs to: one set in a stride of the sets, or in a
+ * fully associative cache, the single sampled set if the hash of the block falls in the sampled share
+ * @params: const hawkeye_base * hawkeye: the state of Hawkeye
+ * @params: unsigned int setIndex: the set of the block
+ * @params: unsigned int numSets: the number of cache sets
+ * @params: unsigned long tag: the tag of the block
+ * @return: the sampled set, -1 if the block isn't sampled
+ */
+static int sampledSet(const hawkeye_base * hawkeye, unsigned int setIndex, unsigned int numSets, unsigned long tag) {
+
+    if (numSets > 1) {
+        unsigned int stride = numSets > hawkeye->units ? numSets / hawkeye->units : 1;  // sample every stride-th set
+        return setIndex % stride == 0 && setIndex / stride < hawkeye->units ? (int) (setIndex / stride) : -1;
+    }
+    return (unsigned int) (tag * 0x9e3779b1u) < hawkeye->share ? 0 : -1;
+}
+
+
+/* void function, replay an access of a sampled set in OPTgen: OPT would have hit the block if, at every access
+ * of the set since the last access of the block, fewer blocks than the set has lines were live. Then the block
+ * was live in between too, and the last access of the block trains its region towards cache-friendly, otherwise
+ * towards cache-averse. An access that leaves the window without being accessed again trains towards cache-averse
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned int setIndex: the set of the block
+ * @params: unsigned int numSets: the number of cache sets
+ * @params: unsigned long tag: the tag of the block
+ * @return: none
+ */
+static void optgen(cache_base * cacheBase, unsigned int setIndex, unsigned int numSets, unsigned long tag) {
+
+    hawkeye_base * hawkeye = hawkeyeOf(cacheBase);
+    int unit = sampledSet(hawkeye, setIndex, numSets, tag);
+    if (unit < 0) {
+        return;
+    }
+
+    unsigned int window = hawkeye->window;
+    unsigned long long * accesses = (unsigned long long *) ((char *) hawkeye + sizeof(hawkeye_base) +
+                                                            (1ul << hawkeye->predictorBits) + unit * unitBytes(hawkeye));
+    unsigned char * occupancy = (unsigned char *) (accesses + 1);
+    unsigned int * tags = (unsigned int *) (occupancy + window);
+    unsigned long long now = *accesses;
+    unsigned int key = (tag + 1) & 0x7fffffff;
+
+    // find the last access of the block in the window, from the most recent access back
+    for (unsigned int back = 1; back < window && back <= now; back++) {
+        unsigned int last = (now - back) % window;
+        if ((tags[last] & 0x7fffffff) != key) {
+            continue;
+        }
+        int hit = 1;
+        for (unsigned int i = 1; i <= back && hit; i++) {
+            hit = occupancy[(now - i) % window] < hawkeye->capacity;
+        }
+        for (unsigned int i = 1; i <= back && hit; i++) {
+            occupancy[(now - i) % window]++;
+        }
+        train(hawkeye, tag, hit);
+        tags[last] |= 0x80000000u;
+        break;
+    }
+
+    // the access leaving the window wasn't followed by another one of its block, OPT wouldn't have kept it
+    unsigned int slot = now % window;
+    if (tags[slot] && !(tags[slot] & 0x80000000u)) {
+        train(hawkeye, tags[slot] - 1, 0);
+    }
+    tags[slot] = key;
+    occupancy[slot] = 0;
+    *accesses = now + 1;
+}
+
+
+/* cache_line * function, pick the line Hawkeye evicts among the ways in mask: an invalid line, else a cache-averse
+ * line (RRPV_MAX), else the oldest cache-friendly line, the least recently used of them if several are as old
+ * @params: cache_set * set: the reference to our using set
+ * @params: unsigned int numOfLines: the number of lines in the set
+ * @params: unsigned int mask: the ways that may be evicted
+ * @return: the line to evict
+ */
+static cache_line * hawkeyeVictim(cache_set * set, unsigned int numOfLines, unsigned int mask) {
+
+    cache_line * evictedLine = 0;
+    for (unsigned int i = 0; i < numOfLines; i++) {
+        cache_line * line = &(set->cacheLineArray[i]);
+        if (i < CACHE_MAX_WAYS && !((mask >> i) & 1)) {
+            continue;
+        }
+        if (!line->valid) {
+            return line;
+        }
+        if (!evictedLine || line->rrpv > evictedLine->rrpv ||
+            (line->rrpv == evictedLine->rrpv && line->time > evictedLine->time)) {
+            evictedLine = line;
+        }
+    }
+    return evictedLine;
+}
+
+
+/* void function, age a block Hawkeye just filled or hit by its prediction: a cache-friendly block becomes the
+ * youngest line and, when it was filled, the other cache-friendly lines age by one, a cache-averse block is
+ * the first to go
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: cache_set * set: the reference to our using set
+ * @params: cache_line * line: the line of the block
+ * @params: unsigned int numOfLines: the number of lines in the set
+ * @params: int filled: 1 if the block was just filled, 0 on a hit
+ * @return: none
+ */
+static void hawkeyeUpdate(cache_base * cacheBase, cache_set * set, cache_line * line, unsigned int numOfLines,
+                          int filled) {
+
+    if (!friendly(cacheBase, line->tag)) {
+        line->rrpv = RRPV_MAX;
+        return;
+    }
+    for (unsigned int i = 0; filled && i < numOfLines; i++) {
+        cache_line * other = &(set->cacheLineArray[i]);
+        other->rrpv += other->rrpv < RRPV_MAX - 1;
+    }
+    line->rrpv = 0;
+}
+
+
+/* cache_line * function, find evict line by using the replacement policy in c_info.policy and evict it
+ * @params: cache_set * set: the reference to our using set
+ * @params: unsigned long tag: the new tag that we want to assign to the evict line
+ * @params: unsigned int numOfLines: the number of lines in the set
+ * @return: the evict line that we have to find
+ */
+static cache_line * findEvict(cache_set * set, unsigned long tag, unsigned int numOfLines) {
+
+    return replaceLine(set, chooseVictim(set, numOfLines, allWays(numOfLines)), tag, numOfLines);
+}
+
+
+/* void function, doing LRU (least recently used) step for the hit line:
+ * add 1 to time from all the lines that less than this line's time,
+ * set the line's time to be 0
+ * @params: cache_set * set: the reference to our using set
+ * @params: cache_line * line: the hit line
+ * @params: unsigned int numOfLines: the number of lines in the set
+ * @return: none
+ */
+static void setLRU(cache_set * set, cache_line * line, unsigned int numOfLines) {
+
+    // iteratively add 1 to time from all the other lines that less than this line's time
+    for (int i = 0; i < numOfLines; i++) {
+        if (set->cacheLineArray[i].time < line->time) {
+            set->cacheLineArray[i].time++;
+        }
+    }
+
+    line->time = 0;  // set the line's time to be 0
+
+    set->mru = line - set->cacheLineArray;  // remember the hit line as the most recently used
+}
+
+
+/* void function, doing LRU (least recently used) step for two lines touched by one access:
+ * the first line becomes the second most recently used, the second line becomes the most recently used,
+ * and all the other lines keep their relative order. This is the same as calling setLRU on the first
+ * line and then on the second line, but takes a single pass
+ * @params: cache_set * set: the reference to our using set
+ * @params: cache_line * first: the line touched first
+ * @params: cache_line * second: the line touched second
+ * @params: unsigned int numOfLines: the number of lines in the set
+ * @return: none
+ */
+static void setLRUPair(cache_set * set, cache_line * first, cache_line * second, unsigned int numOfLines) {
+
+    // the same line touched twice is a single LRU step
+    if (first == second) {
+        setLRU(set, second, numOfLines);
+        return;
+    }
+
+    unsigned int firstTime = first->time;    // the time of the first line before the step
+    unsigned int secondTime = second->time;  // the time of the second line before the step
+
+    /* iteratively add 1 to time from all the other lines for each of the two lines they were
+     * more recently used than, which moves them behind the pair
+     */
+    for (int i = 0; i < numOfLines; i++) {
+        cache_line * line = &(set->cacheLineArray[i]);
+        line->time += (line->time < firstTime) + (line->time < secondTime);
+    }
+
+    first->time = 1;   // the first line is the second most recently used
+    second->time = 0;  // the second line is the most recently used
+
+    set->mru = second - set->cacheLineArray;  // remember the second line as the most recently used
+}
+
+
+/* void function, set up the pointers stored in the fast memory: the cache set array after the cache base
+ * (and the TinyLFU filter, the tenant accounting, the tag directories of DIP, the state of Hawkeye, the set index
+ * function and the accounting that follow it), and the cache line array of each set
+ * at the end of the cache set array, numOfLines lines per set. Compressed and deduplicated sets hold their tags
+ * and data themselves
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: none
+ */
+static void setPointers(cache_base * cacheBase) {
+    cacheBase->cacheSetArray = (struct cache_set *) ((char *) cacheBase + cacheBase->setsOffset);
+    if (cacheBase->flags & (FLAG_COMPRESS | FLAG_DEDUP)) {
+        return;
+    }
+
+    unsigned int numOfLines;
+    unsigned int numSets = setCount(cacheBase, &numOfLines);
+    struct cache_line * lines = (struct cache_line *) (cacheBase->cacheSetArray + (numSets ? numSets : 1));
+    for (unsigned int s = 0; s < numSets; s++) {
+        cacheBase->cacheSetArray[s].cacheLineArray = lines + (unsigned long) s * numOfLines;
+    }
+}
+
+
+/* void function, empty a deduplicated cache: no tag holds a block, every data entry is free and every hash
+ * bucket empty, the statistics are unchanged
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: none
+ */
+static void emptyDedup(cache_base * cacheBase) {
+
+    dedup_base * dedup = dedupOf(cacheBase);
+    unsigned int numOfLines;
+    unsigned long lines = setCount(cacheBase, &numOfLines) * (unsigned long) numOfLines;
+    dedup_entry * entries = entriesOf(cacheBase, lines);
+
+    memset(cacheBase->cacheSetArray, 0, 2 * lines * sizeof(dedup_tag) + lines * sizeof(unsigned int));
+    for (unsigned long i = 0; i < lines; i++) {
+        entries[i].refs = 0;
+        entries[i].next = i + 1 < lines ? i + 2 : 0;
+    }
+    dedup->freeEntries = lines ? 1 : 0;
+    dedup->distinct = 0;
+    dedup->hand = 0;
+    cacheBase->validLines = 0;
+}
+
+
+/* void function, initialize the cache, set up all the pointers and structures,
+ * include the cache base, the tenant accounting, cache sets and cache lines
+ * @params: none
+ * @return: none
+ */
+static void init() {
+
+    /* initialization of the cache_base: create a pointer point to the start of the fast memory,
+     * set initialized flag to 1 which means the cache has been initialized, set the cache set array
+     * at the end of the cache base address
+     */
+    struct cache_base * cacheBase = c_info.F_memory;
+    cacheBase->initialized = 1;
+    memset(&counters, 0, sizeof(counters));
+    cacheBase->seed = 0x2545f491;  // any non-zero seed, fixed so runs are repeatable
+    cacheBase->ways = c_info.ways;
+    cacheBase->tenants = c_info.tenants;
+    cacheBase->flags = (c_info.tenants && c_info.ucp_interval ? FLAG_UCP : 0) |
+                       (c_info.insertion == CACHE_INSERT_DIP ? FLAG_DUEL : 0) |
+                       (c_info.policy == CACHE_POLICY_HAWKEYE ? FLAG_HAWKEYE : 0) |
+                       (c_info.ways && c_info.index != CACHE_INDEX_MODULO ? FLAG_INDEX : 0) |
+                       (c_info.sectors ? FLAG_SECTOR : 0) |
+                       (c_info.ways && c_info.compression ? FLAG_COMPRESS : 0) |
+                       (c_info.ways && c_info.dedup ? FLAG_DEDUP : 0);
+    cacheBase->psel = PSEL_MAX / 2;
+
+    // the number of cache sets and lines depend on the size of the fast memory, and on the metadata in front of them
+    cacheBase->admission = c_info.admission != CACHE_ADMISSION_NONE;
+    layout(cacheBase);
+    if (cacheBase->admission && cacheBase->numSets == 0) {
+        cacheBase->admission = 0;  // the filter only goes in if at least one set still fits behind it
+        layout(cacheBase);
+    }
+    unsigned int numOfLines;
+    unsigned int numSets = setCount(cacheBase, &numOfLines);
+    setPointers(cacheBase);
+
+    if (cacheBase->admission) {
+        tinylfu_init(sketchOf(cacheBase), lineEstimate());
+    }
+    if (cacheBase->flags & FLAG_DUEL) {
+        unsigned int lines = lineEstimate();
+        duelOf(cacheBase)[0] = duelEntries();
+        duelOf(cacheBase)[1] = duelEntries() >= lines ? 0xffffffffu : (unsigned int) (0x100000000ULL * duelEntries() / lines);
+    }
+
+    // the predictor starts weakly cache-friendly, so Hawkeye behaves like LRU aging until OPTgen has trained it
+    hawkeye_base * hawkeye = hawkeyeOf(cacheBase);
+    if (hawkeye) {
+        hawkeyeGeometry(cacheBase->ways, hawkeye);
+        memset(hawkeye->counters, 4, 1ul << hawkeye->predictorBits);
+    }
+
+    // XOR folds as many bits as index the sets at a time, prime takes the largest prime not above the sets
+    index_base * index = indexOf(cacheBase);
+    if (index) {
+        index->function = c_info.index;
+        for (index->bits = 1; (2u << index->bits) <= numSets;) {
+            index->bits++;
+        }
+        for (index->modulus = numSets > 1 ? numSets : 1; index->modulus > 2; index->modulus--) {
+            unsigned int d = 2;
+            while (d * d <= index->modulus && index->modulus % d) {
+                d++;
+            }
+            if (d * d > index->modulus) {
+                break;
+            }
+        }
+    }
+
+    // a sector is a power-of-two share of the block
+    sector_base * sector = sectorOf(cacheBase);
+    if (sector) {
+        sector->sectors = c_info.sectors;
+        sector->sectorBytes = sizeof(((cache_line*)0)->cacheBlock) / c_info.sectors;
+    }
+
+    // a compressed set starts with all its tags free and all its data unused
+    compress_base * compress = compressOf(cacheBase);
+    if (compress) {
+        compress->algorithm = c_info.compression;
+        for (unsigned int s = 0; s < numSets; s++) {
+            compressed_set * set = compressedSet(cacheBase, s);
+            set->used = 0;
+            memset(set->tags, 0, 2ul * numOfLines * sizeof(compressed_tag));
+        }
+        return;
+    }
+    if (dedupOf(cacheBase)) {
+        emptyDedup(cacheBase);
+        return;
+    }
+
+    // the tenants start with the way masks of c_info, UCP repartitions them once it has seen some references
+    tenant_base * tenants = tenantsOf(cacheBase);
+    if (tenants) {
+        tenants->ucpInterval = c_info.ucp_interval;
+        tenants->partitioned = cacheBase->flags & FLAG_UCP;
+        for (unsigned int t = 0; t < cacheBase->tenants; t++) {
+            unsigned int mask = c_info.way_mask[t] & allWays(numOfLines);
+            tenants->tenant[t].wayMask = mask ? mask : allWays(numOfLines);
+            tenants->partitioned |= tenants->tenant[t].wayMask != allWays(numOfLines);
+        }
+    }
+
+    for (unsigned int s = 0; s < numSets; s++) {
+
+        // initialization of the cache_set: line 0 starts with time 0, so it is the most recently used
+        struct cache_set * cacheSet = &(cacheBase->cacheSetArray[s]);
+        cacheSet->mru = 0;
+
+        /* iteratively initialize each cache line: create a pointer point to the corresponding line address,
+         * initialize valid and tag to be 0 and set time increase 1 in order (for LRU)
+         */
+        for (int j = 0; j < numOfLines; j++) {
+            struct cache_line * cacheLine = &(cacheSet->cacheLineArray[j]);
+            cacheLine->time = j;
+            cacheLine->valid = 0;
+            cacheLine->owner = 0;
+            cacheLine->rrpv = RRPV_MAX;
+            cacheLine->sectors = 0;
+            cacheLine->tag = 0;
+        }
+    }
+}
+
+
+/* void function, update the shadow tags (UMON) of the tenant of the current reference, if the set is one
+ * of the sampled sets: they hold the blocks the tenant would have in the set if it had all the ways to itself,
+ * in LRU order, so a hit at stack position i would be a hit with at least i + 1 ways
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned int setIndex: the set of the block
+ * @params: unsigned int numSets: the number of cache sets
+ * @params: unsigned int numOfLines: the number of lines in each set
+ * @params: unsigned long tag: the tag of the block
+ * @return: none
+ */
+static void monitor(cache_base * cacheBase, unsigned int setIndex, unsigned int numSets, unsigned int numOfLines,
+                    unsigned long tag) {
+
+    unsigned int stride = numSets > UCP_SETS ? numSets / UCP_SETS : 1;  // sample every stride-th set
+    if (setIndex % stride != 0 || setIndex / stride >= UCP_SETS) {
+        return;
+    }
+
+    tenant_base * tenants = tenantsOf(cacheBase);
+    unsigned int tenant = currentTenant(cacheBase);
+    unsigned int * shadow = (unsigned int *) (tenants->tenant + cacheBase->tenants) +
+                            ((unsigned long) tenant * UCP_SETS + setIndex / stride) * numOfLines;
+    unsigned int key = tag + 1;  // 0 is an empty shadow tag
+
+    // a hit counts at its stack position, a miss drops the least recently used tag
+    unsigned int position = numOfLines - 1;
+    for (unsigned int i = 0; i < numOfLines; i++) {
+        if (shadow[i] == key) {
+            tenants->tenant[tenant].umonHits[i]++;
+            position = i;
+            break;
+        }
+    }
+    memmove(shadow + 1, shadow, position * sizeof(unsigned int));
+    shadow[0] = key;
+}
+
+
+/* void function, utility-based cache partitioning (UCP): every tenant keeps at least one way, the other ways
+ * go by the lookahead algorithm to the tenant whose shadow tags gain the most hits per extra way, and each
+ * tenant gets a contiguous run of ways. The hit counters are halved afterwards so the partition follows phases
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned int numOfLines: the number of lines in each set
+ * @return: none
+ */
+static void repartition(cache_base * cacheBase, unsigned int numOfLines) {
+
+    tenant_base * tenants = tenantsOf(cacheBase);
+    unsigned int numTenants = cacheBase->tenants;
+    unsigned int allocation[CACHE_MAX_TENANTS];  // the ways of each tenant
+
+    tenants->accesses = 0;
+    if (numOfLines < numTenants || numOfLines > CACHE_MAX_WAYS) {
+        return;
+    }
+
+    for (unsigned int t = 0; t < numTenants; t++) {
+        allocation[t] = 1;
+    }
+    for (unsigned int balance = numOfLines - numTenants; balance > 0;) {
+        unsigned int winner = 0;      // the tenant with the best marginal utility
+        unsigned int winnerWays = 1;  // the ways it gets
+        double best = -1;             // its hits per extra way
+        for (unsigned int t = 0; t < numTenants; t++) {
+            unsigned long long gain = 0;
+            for (unsigned int k = 1; k <= balance; k++) {
+                gain += tenants->tenant[t].umonHits[allocation[t] + k - 1];
+                if ((double) gain / k > best) {
+                    best = (double) gain / k;
+                    winner = t;
+                    winnerWays = k;
+                }
+            }
+        }
+        allocation[winner] += winnerWays;
+        balance -= winnerWays;
+    }
+
+    unsigned int firstWay = 0;
+    for (unsigned int t = 0; t < numTenants; t++) {
+        tenants->tenant[t].wayMask = (unsigned int) (((1ULL << allocation[t]) - 1) << firstWay);
+        firstWay += allocation[t];
+        for (unsigned int i = 0; i < CACHE_MAX_WAYS; i++) {
+            tenants->tenant[t].umonHits[i] /= 2;
+        }
+    }
+}
+
+
+/* void function, count a reference for UCP, and repartition the ways every ucpInterval references
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @return: none
+ */
+static void count_access(cache_base * cacheBase) {
+
+    tenant_base * tenants = tenantsOf(cacheBase);
+    if ((cacheBase->flags & FLAG_UCP) && ++tenants->accesses >= tenants->ucpInterval) {
+        unsigned int numOfLines;
+        setCount(cacheBase, &numOfLines);
+        repartition(cacheBase, numOfLines);
+    }
+}
+
+
+/* unsigned char * function, get the touched mask of a line in the sector accounting, the lines of all the sets
+ * are one array
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: sector_base * sector: the sector accounting
+ * @params: cache_line * line: the line
+ * @return: the touched mask of the line
+ */
+static unsigned char * touchedOf(cache_base * cacheBase, sector_base * sector, cache_line * line) {
+
+    return &(sector->touched[line - cacheBase->cacheSetArray[0].cacheLineArray]);
+}
+
+
+/* unsigned char function, get the 8-byte words of a block an access references
+ * @params: unsigned long long need: the bytes of the block the access reads, one bit each
+ * @return: the words, one bit each
+ */
+static unsigned char wordMask(unsigned long long need) {
+
+    unsigned char words = 0;
+    for (unsigned int i = 0; i < 8; i++) {
+        words |= ((need >> (8 * i)) & 0xff ? 1 : 0) << i;
+    }
+    return words;
+}
+
+
+/* void function, count the bytes a block leaving a line had referenced, and leave the line without sectors
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: sector_base * sector: the sector accounting
+ * @params: cache_line * line: the line about to lose its block
+ * @return: none
+ */
+static void dropSectors(cache_base * cacheBase, sector_base * sector, cache_line * line) {
+
+    unsigned char * touched = touchedOf(cacheBase, sector, line);
+    if (line->valid) {
+        sector->used += 8 * __builtin_popcount(*touched);
+    }
+    *touched = 0;
+    line->sectors = 0;
+}
+
+
+/* int function, load the sectors of a line an access needs that aren't valid yet, one memget each, and mark the
+ * words the access references. Loading sectors into a line that hit counts as a fill, so the access is a miss.
+ * The sectors of a line warming filled with its tag only are only marked valid
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: sector_base * sector: the sector accounting
+ * @params: cache_line * line: the line of the block
+ * @params: unsigned long blockAddress: the address of the first byte of the block
+ * @params: unsigned long long need: the bytes of the block the access reads, one bit each
+ * @params: int hit: 1 if the line already held the block, 0 if it was just filled
+ * @return: 1 on success and 0 on failure
+ */
+static int loadSectors(cache_base * cacheBase, sector_base * sector, cache_line * line, unsigned long blockAddress,
+                       unsigned long long need, int hit) {
+
+    unsigned int size = sector->sectorBytes;
+    unsigned long long sectorMask = size == 64 ? ~0ULL : (1ULL << size) - 1;  // the bytes of the first sector
+    unsigned int loaded = 0;
+
+    *touchedOf(cacheBase, sector, line) |= wordMask(need);
+    for (unsigned int s = 0; s < sector->sectors; s++) {
+        if (!((need >> (s * size)) & sectorMask) || ((line->sectors >> s) & 1)) {
+            continue;
+        }
+        if (line->valid != LINE_WARMED && !memget(blockAddress + s * size, line->cacheBlock + s * size, size)) {
+            return 0;
+        }
+        line->sectors |= 1u << s;
+        sector->fetched += cacheBase->warming ? 0 : size;
+        loaded++;
+    }
+    if (hit && loaded) {
+        count_bypass(cacheBase);
+    }
+    return 1;
+}
+
+
+/* int function, load a block past the cache into buffer, because the admission filter kept the line the policy
+ * picked, the whole block is loaded and only the words the access reads are used, not while warming
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned long blockAddress: the address of the first byte of the block
+ * @params: unsigned long long need: the bytes of the block the access reads, one bit each
+ * @params: unsigned char * buffer: where the block is loaded, 0 to not load it
+ * @params: const unsigned char ** block: where the pointer to the data of the block is stored
+ * @return: 1 on success and 0 on failure
+ */
+static int bypass(cache_base * cacheBase, unsigned long blockAddress, unsigned long long need, unsigned char * buffer,
+                  const unsigned char ** block) {
+
+    // compute the size of a single block (we will not access (cache_line*)0, just for size computation)
+    unsigned int sizeOfBlock = sizeof(((cache_line*)0)->cacheBlock);
+
+    sector_base * sector = sectorOf(cacheBase);
+    count_bypass(cacheBase);
+    if (sector && !cacheBase->warming) {
+        sector->fetched += sizeOfBlock;
+        sector->used += 8 * __builtin_popcount(wordMask(need));
+    }
+    *block = buffer;
+    return !buffer || cacheBase->warming || memget(blockAddress, buffer, sizeOfBlock);
+}
+
+
+/* int function, load the block of a line warming filled with its tag only, or in a sectored cache its valid
+ * sectors, with mempeek: the line already holds the block as far as the replacement and the statistics go,
+ * so this is neither a fill nor a main memory access
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: cache_line * line: the line, its valid bit LINE_WARMED
+ * @params: unsigned long blockAddress: the address of the first byte of the block
+ * @return: 1 on success and 0 on failure
+ */
+static int loadWarmed(cache_base * cacheBase, cache_line * line, unsigned long blockAddress) {
+
+    sector_base * sector = sectorOf(cacheBase);
+    unsigned int size = sector ? sector->sectorBytes : sizeof(line->cacheBlock);
+
+    line->valid = 1;
+    for (unsigned int s = 0; s < sizeof(line->cacheBlock) / size; s++) {
+        if ((!sector || ((line->sectors >> s) & 1)) &&
+            !mempeek(blockAddress + s * size, line->cacheBlock + s * size, size)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/* int function, hand out the block of a line that holds it, in a sectored cache after loading the sectors
+ * the access needs that the line doesn't have yet. The first access past warming to a line warming filled
+ * loads its block
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: cache_line * line: the line that holds the block
+ * @params: unsigned long blockAddress: the address of the first byte of the block
+ * @params: unsigned long long need: the bytes of the block the access reads, one bit each
+ * @params: const unsigned char ** block: where the pointer to the data of the block is stored
+ * @return: 1 on success and 0 on failure
+ */
+static int hitLine(cache_base * cacheBase, cache_line * line, unsigned long blockAddress, unsigned long long need,
+                   const unsigned char ** block) {
+
+    sector_base * sector = sectorOf(cacheBase);
+    *block = line->cacheBlock;
+    if (line->valid == LINE_WARMED && !cacheBase->warming && !loadWarmed(cacheBase, line, blockAddress)) {
+        return 0;
+    }
+    return !sector || loadSectors(cacheBase, sector, line, blockAddress, need, 1);
+}
+
+
+/* int function, load a block into the line just filled with its tag: the whole block, or in a sectored cache
+ * only the sectors the access needs. While warming the block isn't loaded, the line is marked LINE_WARMED
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: cache_line * line: the line that was filled
+ * @params: unsigned long blockAddress: the address of the first byte of the block
+ * @params: unsigned long long need: the bytes of the block the access reads, one bit each
+ * @params: const unsigned char ** block: where the pointer to the data of the block is stored
+ * @return: 1 on success and 0 on failure
+ */
+static int loadLine(cache_base * cacheBase, cache_line * line, unsigned long blockAddress, unsigned long long need,
+                    const unsigned char ** block) {
+
+    // compute the size of a single block (we will not access (cache_line*)0, just for size computation)
+    unsigned int sizeOfBlock = sizeof(((cache_line*)0)->cacheBlock);
+
+    sector_base * sector = sectorOf(cacheBase);
+    *block = line->cacheBlock;
+    if (cacheBase->warming) {
+        line->valid = LINE_WARMED;
+    }
+    if (sector) {
+        return loadSectors(cacheBase, sector, line, blockAddress, need, 0);
+    }
+    return cacheBase->warming || memget(blockAddress, line->cacheBlock, sizeOfBlock) != 0;
+}
+
+
+/* int function, walk the replacement candidates of a ZCache breadth first: the lines of the missing block in each
+ * way, then for the block of each candidate the lines it could move to in its other ways, up to ZCACHE_LEVELS
+ * levels and ZCACHE_CANDIDATES candidates. The walk stops at the first invalid line, otherwise LRU and FIFO
+ * pick the candidate used (or filled) longest ago and random a random one. A line is only a candidate once,
+ * so the blocks on the path to the victim can move one step each
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned long tag: the tag of the missing block
+ * @params: unsigned int numSets: the number of cache sets
+ * @params: unsigned int numOfLines: the number of lines in each set, the ways
+ * @params: zcache_candidate * candidates: where the candidates are stored
+ * @params: unsigned int * count: where the number of candidates is stored
+ * @return: the candidate to evict
+ */
+static int zcacheWalk(cache_base * cacheBase, unsigned long tag, unsigned int numSets, unsigned int numOfLines,
+                      zcache_candidate * candidates, unsigned int * count) {
+
+    unsigned int n = 0;       // the candidates so far
+    unsigned int first = 0;   // the first candidate of the level being expanded
+    int victim = -1;          // the least recently used candidate
+
+    for (unsigned int level = 0; level < ZCACHE_LEVELS && n < ZCACHE_CANDIDATES; level++) {
+        unsigned int last = n;  // the end of the level being expanded
+        for (unsigned int c = level ? first : 0; c < (level ? last : 1); c++) {
+            unsigned long block = level ? candidates[c].line->tag : tag;
+            for (unsigned int w = 0; w < numOfLines && n < ZCACHE_CANDIDATES; w++) {
+                if (level && w == candidates[c].way) {
+                    continue;
+                }
+                cache_line * line = &(cacheBase->cacheSetArray[skewedSet(block, w, numSets)].cacheLineArray[w]);
+                unsigned int seen = 0;
+                while (seen < n && candidates[seen].line != line) {
+                    seen++;
+                }
+                if (seen < n) {
+                    continue;
+                }
+                candidates[n].line = line;
+                candidates[n].parent = level ? (int) c : -1;
+                candidates[n].way = w;
+                if (!line->valid) {
+                    *count = n + 1;
+                    return n;
+                }
+                if (victim < 0 || line->time < candidates[victim].line->time) {
+                    victim = n;
+                }
+                n++;
+            }
+        }
+        first = last;
+    }
+    *count = n;
+    return c_info.policy == CACHE_POLICY_RANDOM ? (int) random_line(n) : victim;
+}
+
+
+/* cache_line * function, make room for a missing block in a ZCache: the victim is evicted, and every block on the
+ * path from a line of the missing block to the victim moves one step down into the line the walk reached it by
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: index_base * index: the set index function, with the relocation count
+ * @params: zcache_candidate * candidates: the candidates of the walk
+ * @params: int victim: the candidate to evict
+ * @return: the line of the missing block the path starts at, now free for the block
+ */
+static cache_line * relocate(cache_base * cacheBase, index_base * index, zcache_candidate * candidates, int victim) {
+
+    sector_base * sector = sectorOf(cacheBase);
+    if (sector) {
+        dropSectors(cacheBase, sector, candidates[victim].line);
+    }
+    count_fill(candidates[victim].line);
+    unsigned char owner = candidates[victim].line->owner;  // the tenant of the missing block
+
+    int c = victim;
+    for (; candidates[c].parent >= 0; c = candidates[c].parent) {
+        cache_line * to = candidates[c].line;
+        cache_line * from = candidates[candidates[c].parent].line;
+        to->time = from->time;
+        to->owner = from->owner;
+        to->tag = from->tag;
+        to->valid = from->valid;
+        to->sectors = from->sectors;
+        memcpy(to->cacheBlock, from->cacheBlock, sizeof(to->cacheBlock));
+        if (sector) {
+            *touchedOf(cacheBase, sector, to) = *touchedOf(cacheBase, sector, from);
+        }
+        index->relocations += !cacheBase->warming;
+    }
+    candidates[c].line->owner = owner;
+    if (sector) {
+        *touchedOf(cacheBase, sector, candidates[c].line) = 0;
+        candidates[c].line->sectors = 0;
+    }
+    return candidates[c].line;
+}
+
+
+/* int function, find the block with the given tag in a skewed-associative cache, where every way indexes its
+ * lines with its own hash: a lookup probes one line per way, and on a miss the candidates are those lines,
+ * LRU and FIFO evict the one used (or filled) longest ago by its time stamp, random a random one, only among
+ * the ways the tenant may fill. A ZCache walks further candidates and relocates blocks to evict the best of them.
+ * The admission filter may keep the victim, then the block is loaded into buffer
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: index_base * index: the set index function, with the clock of the time stamps
+ * @params: unsigned long tag: the tag of the block
+ * @params: unsigned long blockAddress: the address of the first byte of the block
+ * @params: unsigned int numSets: the number of cache sets
+ * @params: unsigned int numOfLines: the number of lines in each set, the ways
+ * @params: unsigned long long need: the bytes of the block the access reads, one bit each
+ * @params: unsigned char * buffer: where a bypassed block is loaded, 0 to not load it
+ * @params: const unsigned char ** block: where the pointer to the data of the block is stored
+ * @return: 1 on success and 0 on failure
+ */
+static int skewedBlock(cache_base * cacheBase, index_base * index, unsigned long tag, unsigned long blockAddress,
+                       unsigned int numSets, unsigned int numOfLines, unsigned long long need,
+                       unsigned char * buffer, const unsigned char ** block) {
+
+    unsigned int mask = allocationMask(cacheBase, numOfLines);
+    cache_line * evictedLine = 0;  // the candidate to evict, an invalid line first
+    index->clock++;
+
+    for (unsigned int w = 0; w < numOfLines; w++) {
+        cache_line * line = &(cacheBase->cacheSetArray[skewedSet(tag, w, numSets)].cacheLineArray[w]);
+        if (line->valid && line->tag == tag) {
+            if (c_info.policy == CACHE_POLICY_LRU) {
+                line->time = index->clock;
+            }
+            return hitLine(cacheBase, line, blockAddress, need, block);
+        }
+        if (w < CACHE_MAX_WAYS && !((mask >> w) & 1)) {
+            continue;
+        }
+        if (!evictedLine || (evictedLine->valid && (!line->valid || line->time < evictedLine->time))) {
+            evictedLine = line;
+        }
+    }
+
+    if (c_info.policy == CACHE_POLICY_RANDOM) {
+        unsigned int w;
+        do {
+            w = random_line(numOfLines);
+        } while (w < CACHE_MAX_WAYS && !((mask >> w) & 1));
+        evictedLine = &(cacheBase->cacheSetArray[skewedSet(tag, w, numSets)].cacheLineArray[w]);
+    }
+
+    zcache_candidate candidates[ZCACHE_CANDIDATES];
+    unsigned int count = 0;
+    int victim = -1;  // the candidate of the walk to evict, -1 without a walk
+    if (index->function == CACHE_INDEX_ZCACHE && evictedLine->valid) {
+        victim = zcacheWalk(cacheBase, tag, numSets, numOfLines, candidates, &count);
+        evictedLine = candidates[victim].line;
+        index->candidates += cacheBase->warming ? 0 : count;
+    }
+    if (!admit(cacheBase, tag, evictedLine)) {
+        return bypass(cacheBase, blockAddress, need, buffer, block);
+    }
+
+    if (victim >= 0) {
+        evictedLine = relocate(cacheBase, index, candidates, victim);
+    } else {
+        if (sectorOf(cacheBase)) {
+            dropSectors(cacheBase, sectorOf(cacheBase), evictedLine);
+        }
+        count_fill(evictedLine);
+    }
+    evictedLine->tag = tag;
+    evictedLine->valid = 1;
+    evictedLine->time = index->clock;
+
+    // load the block from memory into the evicted line, return 0 since we fail to find the value otherwise
+    return loadLine(cacheBase, evictedLine, blockAddress, need, block);
+}
+
+
+/* unsigned int function, compress a block with the algorithm of a compressed cache, with both of them for
+ * CACHE_COMPRESS_BEST, which keeps the smaller result
+ * @params: unsigned int algorithm: CACHE_COMPRESS_BDI, CACHE_COMPRESS_FPC or CACHE_COMPRESS_BEST
+ * @params: const unsigned char * block: the block
+ * @params: unsigned char * out: where the compressed form goes, COMPRESS_BLOCK bytes
+ * @params: unsigned char * encoding: where the algorithm of the compressed form is stored, CACHE_COMPRESS_NONE
+ *          if the block doesn't compress
+ * @return: the compressed size, COMPRESS_BLOCK if the block doesn't compress
+ */
+static unsigned int compressBlock(unsigned int algorithm, const unsigned char * block, unsigned char * out,
+                                  unsigned char * encoding) {
+
+    unsigned int size = COMPRESS_BLOCK;
+    *encoding = CACHE_COMPRESS_NONE;
+    if (algorithm != CACHE_COMPRESS_FPC) {
+        size = bdi_compress(block, out);
+        *encoding = size < COMPRESS_BLOCK ? CACHE_COMPRESS_BDI : CACHE_COMPRESS_NONE;
+    }
+    if (algorithm != CACHE_COMPRESS_BDI) {
+        unsigned char fpc[COMPRESS_BLOCK];
+        unsigned int fpcSize = fpc_compress(block, fpc);
+        if (fpcSize < size) {
+            memcpy(out, fpc, fpcSize);
+            size = fpcSize;
+            *encoding = CACHE_COMPRESS_FPC;
+        }
+    }
+    return size;
+}
+
+
+/* void function, evict the block of a tag of a compressed set: the blocks stored after it move down over its
+ * segments, so the data of the set stays packed
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: compressed_set * set: the set
+ * @params: compressed_tag * victim: the tag to evict, it holds a block
+ * @params: unsigned int numOfLines: the ways of the set, it has twice as many tags
+ * @return: none
+ */
+static void evictCompressed(cache_base * cacheBase, compressed_set * set, compressed_tag * victim,
+                            unsigned int numOfLines) {
+
+    unsigned char * data = (unsigned char *) (set->tags + 2 * numOfLines);
+    unsigned int end = victim->start + victim->segments;  // the first segment after the block
+
+    memmove(data + victim->start * SEGMENT_BYTES, data + end * SEGMENT_BYTES, (set->used - end) * SEGMENT_BYTES);
+    for (unsigned int i = 0; i < 2 * numOfLines; i++) {
+        if (set->tags[i].segments && set->tags[i].start >= end) {
+            set->tags[i].start -= victim->segments;
+        }
+    }
+    set->used -= victim->segments;
+    victim->segments = 0;
+
+    cacheBase->validLines--;
+    counters.stats.evictions += !cacheBase->warming;
+}
+
+
+/* int function, find the block with the given tag in a compressed set, a hit decompresses it into buffer. On
+ * a miss the block is loaded into buffer and compressed, and blocks are evicted until a tag and enough segments
+ * are free for it: LRU and FIFO evict the block used (or filled) longest ago by its time stamp, random a random
+ * one, so a fill may evict several blocks that compressed badly, or none at all
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: compress_base * compress: the compression accounting, with the clock of the time stamps
+ * @params: compressed_set * set: the set of the block
+ * @params: unsigned long tag: the tag of the block
+ * @params: unsigned long blockAddress: the address of the first byte of the block
+ * @params: unsigned int numOfLines: the ways of the set, it has twice as many tags
+ * @params: unsigned char * buffer: where the block is stored, 0 to not hand it out
+ * @params: const unsigned char ** block: where the pointer to the data of the block is stored
+ * @return: 1 on success and 0 on failure
+ */
+static int compressedBlock(cache_base * cacheBase, compress_base * compress, compressed_set * set, unsigned long tag,
+                           unsigned long blockAddress, unsigned int numOfLines, unsigned char * buffer,
+                           const unsigned char ** block) {
+
+    unsigned char * data = (unsigned char *) (set->tags + 2 * numOfLines);
+    compressed_tag * freeTag = 0;  // a tag without a block
+    compress->clock++;
+
+    for (unsigned int i = 0; i < 2 * numOfLines; i++) {
+        compressed_tag * entry = &(set->tags[i]);
+        if (entry->segments && entry->tag == tag) {
+            if (c_info.policy == CACHE_POLICY_LRU) {
+                entry->time = compress->clock;
+            }
+            *block = buffer;
+            if (!buffer) {
+                return 1;
+            }
+            if (entry->encoding == CACHE_COMPRESS_BDI) {
+                bdi_decompress(data + entry->start * SEGMENT_BYTES, buffer);
+            } else if (entry->encoding == CACHE_COMPRESS_FPC) {
+                fpc_decompress(data + entry->start * SEGMENT_BYTES, buffer);
+            } else {
+                memcpy(buffer, data + entry->start * SEGMENT_BYTES, COMPRESS_BLOCK);
+            }
+            return 1;
+        }
+        if (!entry->segments && !freeTag) {
+            freeTag = entry;
+        }
+    }
+
+    // a miss loads the block, warming still needs it to compress
+    unsigned char temp[COMPRESS_BLOCK];
+    unsigned char * fill = buffer ? buffer : temp;
+    *block = buffer;
+    if (!memget(blockAddress, fill, COMPRESS_BLOCK)) {
+        return 0;
+    }
+    unsigned char packed[COMPRESS_BLOCK];
+    unsigned char encoding;
+    unsigned int size = compressBlock(compress->algorithm, fill, packed, &encoding);
+    unsigned int segments = (size + SEGMENT_BYTES - 1) / SEGMENT_BYTES;
+    if (!cacheBase->warming) {
+        counters.stats.fills++;
+        compress->fills++;
+        compress->bytes += size;
+    }
+
+    // evict until a tag and the segments of the block are free
+    while (!freeTag || set->used + segments > numOfLines * COMPRESS_BLOCK / SEGMENT_BYTES) {
+        compressed_tag * victim = 0;
+        unsigned int valid = 0;  // the tags that hold a block
+        for (unsigned int i = 0; i < 2 * numOfLines; i++) {
+            compressed_tag * entry = &(set->tags[i]);
+            valid += entry->segments != 0;
+            if (entry->segments && (!victim || entry->time < victim->time)) {
+                victim = entry;
+            }
+        }
+        if (c_info.policy == CACHE_POLICY_RANDOM) {
+            unsigned int pick = random_line(valid);
+            for (victim = set->tags; !victim->segments || pick--; victim++) {
+            }
+        }
+        evictCompressed(cacheBase, set, victim, numOfLines);
+        freeTag = freeTag ? freeTag : victim;
+    }
+
+    freeTag->tag = tag;
+    freeTag->time = compress->clock;
+    freeTag->start = set->used;
+    freeTag->segments = segments;
+    freeTag->encoding = encoding;
+    memcpy(data + set->used * SEGMENT_BYTES, encoding == CACHE_COMPRESS_NONE ? fill : packed, size);
+    set->used += segments;
+    cacheBase->validLines++;
+    return 1;
+}
+
+
+/* unsigned int function, hash the contents of a block for the hash buckets of a deduplicated cache, a
+ * multiply-xor over its eight 8-byte words
+ * @params: const unsigned char * block: the block
+ * @return: the hash
+ */
+static unsigned int blockHash(const unsigned char * block) {
+
+    unsigned long long hash = 0;
+    for (unsigned int i = 0; i < COMPRESS_BLOCK; i += 8) {
+        unsigned long long word;
+        memcpy(&word, block + i, 8);
+        hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+    }
+    return (unsigned int) (hash ^ (hash >> 32));
+}
+
+
+/* void function, take the block of a tag of a deduplicated set away: the tag leaves the sharers of its data entry,
+ * and an entry no tag points at any more leaves its hash bucket for the free entries
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: dedup_base * dedup: the deduplication accounting
+ * @params: unsigned long lines: the data entries
+ * @params: unsigned long index: the tag, counted over the tags of all the sets
+ * @return: none
+ */
+static void dropTag(cache_base * cacheBase, dedup_base * dedup, unsigned long lines, unsigned long index) {
+
+    dedup_tag * tags = (dedup_tag *) cacheBase->cacheSetArray;
+    unsigned int * buckets = bucketsOf(cacheBase, lines);
+    dedup_entry * entries = entriesOf(cacheBase, lines);
+    unsigned int e = tags[index].entry - 1;
+
+    unsigned int * link = &(entries[e].sharers);
+    while (*link != index + 1) {
+        link = &(tags[*link - 1].sharer);
+    }
+    *link = tags[index].sharer;
+    tags[index].entry = 0;
+    cacheBase->validLines--;
+    counters.stats.evictions += !cacheBase->warming;
+
+    if (--entries[e].refs == 0) {
+        link = &(buckets[entries[e].hash % lines]);
+        while (*link != e + 1) {
+            link = &(entries[*link - 1].next);
+        }
+        *link = entries[e].next;
+        entries[e].next = dedup->freeEntries;
+        dedup->freeEntries = e + 1;
+        dedup->distinct--;
+    }
+}
+
+
+/* unsigned int function, get a free data entry of a deduplicated cache. Without one, CLOCK sweeps the entries,
+ * an entry hit since the hand passed it last gets another round, the first other one is freed by evicting
+ * every tag that shares it
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: dedup_base * dedup: the deduplication accounting
+ * @params: unsigned long lines: the data entries
+ * @return: the entry, out of the free entries
+ */
+static unsigned int allocateEntry(cache_base * cacheBase, dedup_base * dedup, unsigned long lines) {
+
+    dedup_entry * entries = entriesOf(cacheBase, lines);
+    while (!dedup->freeEntries) {
+        dedup_entry * entry = &(entries[dedup->hand]);
+        dedup->hand = dedup->hand + 1 < lines ? dedup->hand + 1 : 0;
+        if (entry->referenced) {
+            entry->referenced = 0;
+            continue;
+        }
+        while (entry->sharers) {
+            dropTag(cacheBase, dedup, lines, entry->sharers - 1);
+        }
+    }
+    unsigned int e = dedup->freeEntries - 1;
+    dedup->freeEntries = entries[e].next;
+    dedup->distinct++;
+    return e;
+}
+
+
+/* int function, find the block with the given tag in a deduplicated set. On a miss the block is loaded and
+ * hashed, and if a data entry already holds the same 64 bytes the tag shares it, otherwise the block takes a free
+ * entry. The tag is a free tag of the set, or LRU and FIFO evict the tag used (or filled) longest ago by its
+ * time stamp, random a random one. Identical blocks are kept once, so the cache holds more blocks than entries
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: dedup_base * dedup: the deduplication accounting, with the clock of the time stamps
+ * @params: unsigned int setIndex: the set of the block
+ * @params: unsigned long tag: the tag of the block
+ * @params: unsigned long blockAddress: the address of the first byte of the block
+ * @params: unsigned int numSets: the number of cache sets
+ * @params: unsigned int numOfLines: the ways of a set, it has twice as many tags
+ * @params: const unsigned char ** block: where the pointer to the data of the block is stored
+ * @return: 1 on success and 0 on failure
+ */
+static int dedupBlock(cache_base * cacheBase, dedup_base * dedup, unsigned int setIndex, unsigned long tag,
+                      unsigned long blockAddress, unsigned int numSets, unsigned int numOfLines,
+                      const unsigned char ** block) {
+
+    unsigned long lines = numSets * (unsigned long) numOfLines;
+    unsigned long first = 2ul * numOfLines * setIndex;  // the first tag of the set
+    dedup_tag * tags = (dedup_tag *) cacheBase->cacheSetArray;
+    unsigned int * buckets = bucketsOf(cacheBase, lines);
+    dedup_entry * entries = entriesOf(cacheBase, lines);
+    dedup->clock++;
+
+    long freeTag = -1;  // a tag of the set without a block
+    for (unsigned long i = first; i < first + 2 * numOfLines; i++) {
+        if (tags[i].entry && tags[i].tag == tag) {
+            if (c_info.policy == CACHE_POLICY_LRU) {
+                tags[i].time = dedup->clock;
+            }
+            entries[tags[i].entry - 1].referenced = 1;
+            *block = entries[tags[i].entry - 1].block;
+            return 1;
+        }
+        if (!tags[i].entry && freeTag < 0) {
+            freeTag = i;
+        }
+    }
+
+    // a miss loads the block and looks for the same contents in its hash bucket
+    unsigned char data[COMPRESS_BLOCK];
+    if (!memget(blockAddress, data, COMPRESS_BLOCK)) {
+        return 0;
+    }
+    unsigned int hash = blockHash(data);
+    unsigned int e = 0;  // the entry of the block, plus 1
+    unsigned long long probes = 0, compares = 0;
+    for (unsigned int next = buckets[hash % lines]; next && !e; next = entries[next - 1].next) {
+        probes++;
+        if (entries[next - 1].hash == hash) {
+            compares++;
+            e = memcmp(entries[next - 1].block, data, COMPRESS_BLOCK) ? 0 : next;
+        }
+    }
+    if (!cacheBase->warming) {
+        counters.stats.fills++;
+        dedup->fills++;
+        dedup->deduplicated += e != 0;
+        dedup->probes += probes;
+        dedup->compares += compares;
+    }
+
+    // the entry holds a reference before the tag is picked, so evicting a tag of the same contents keeps it
+    if (e) {
+        entries[e - 1].refs++;
+    } else {
+        e = allocateEntry(cacheBase, dedup, lines) + 1;
+        dedup_entry * entry = &(entries[e - 1]);
+        entry->hash = hash;
+        entry->refs = 1;
+        entry->referenced = 0;
+        entry->sharers = 0;
+        memcpy(entry->block, data, COMPRESS_BLOCK);
+        entry->next = buckets[hash % lines];
+        buckets[hash % lines] = e;
+
+        // freeing the entry may have evicted a tag of the set
+        for (unsigned long i = first; i < first + 2 * numOfLines && freeTag < 0; i++) {
+            if (!tags[i].entry) {
+                freeTag = i;
+            }
+        }
+    }
+
+    if (freeTag < 0) {
+        freeTag = first;
+        for (unsigned long i = first; i < first + 2 * numOfLines; i++) {
+            freeTag = tags[i].time < tags[freeTag].time ? (long) i : freeTag;
+        }
+        if (c_info.policy == CACHE_POLICY_RANDOM) {
+            freeTag = first + random_line(2 * numOfLines);
+        }
+        dropTag(cacheBase, dedup, lines, freeTag);
+    }
+
+    dedup_tag * entryTag = &(tags[freeTag]);
+    entryTag->tag = tag;
+    entryTag->time = dedup->clock;
+    entryTag->entry = e;
+    entryTag->sharer = entries[e - 1].sharers;
+    entries[e - 1].sharers = freeTag + 1;
+    cacheBase->validLines++;
+    *block = entries[e - 1].block;
+    return 1;
+}
+
+
+/* int function, find the block with the given tag in its set, on a miss fill a line of the set with the block
+ * from main memory, unless the admission filter keeps the line the policy picked, then the block is loaded
+ * past the cache into buffer. A compressed set hands out its blocks in buffer, a deduplicated set hands out the
+ * data entry a block shares
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: unsigned long tag: the tag of the block
+ * @params: unsigned long blockAddress: the address of the first byte of the block
+ * @params: unsigned int numSets: the number of cache sets
+ * @params: unsigned int numOfLines: the number of lines in each set
+ * @params: unsigned long long need: the bytes of the block the access reads, one bit each
+ * @params: unsigned char * buffer: where a bypassed block is loaded, 0 to not load it
+ * @params: const unsigned char ** block: where the pointer to the data of the block is stored
+ * @return: 1 on success and 0 on failure
+ */
+static int getBlock(cache_base * cacheBase, unsigned long tag, unsigned long blockAddress, unsigned int numSets,
+                    unsigned int numOfLines, unsigned long long need, unsigned char * buffer,
+                    const unsigned char ** block) {
+
+    // get the set we will use in the cache, a fully associative cache has a single set
+    index_base * index = indexOf(cacheBase);
+    if (index && index->function >= CACHE_INDEX_SKEW) {
+        return skewedBlock(cacheBase, index, tag, blockAddress, numSets, numOfLines, need, buffer, block);
+    }
+    unsigned int setIndex = numSets == 1 ? 0 : (index ? hashedSet(index, tag, numSets) : tag % numSets);
+    dedup_base * dedup = dedupOf(cacheBase);
+    if (dedup) {
+        return dedupBlock(cacheBase, dedup, setIndex, tag, blockAddress, numSets, numOfLines, block);
+    }
+    compress_base * compress = compressOf(cacheBase);
+    if (compress) {
+        return compressedBlock(cacheBase, compress, compressedSet(cacheBase, setIndex), tag, blockAddress, numOfLines,
+                               buffer, block);
+    }
+    cache_set * set = &(cacheBase->cacheSetArray[setIndex]);
+    if (cacheBase->flags & FLAG_UCP) {
+        monitor(cacheBase, setIndex, numSets, numOfLines, tag);
+    }
+    if (c_info.insertion == CACHE_INSERT_DIP && !leaderSets(cacheBase, numSets)) {
+        sampleDuel(cacheBase, tag);
+    }
+    int hawkeye = c_info.policy == CACHE_POLICY_HAWKEYE;
+    if (hawkeye && hawkeyeOf(cacheBase)) {
+        optgen(cacheBase, setIndex, numSets, tag);
+    }
+
+    /* fast path: if the most recently used line holds the tag, it is a hit and the LRU order
+     * does not change, so we can skip both the tag scan and the LRU step
+     */
+    cache_line * mruLine = &(set->cacheLineArray[set->mru]);
+    if (mruLine->valid && mruLine->tag == tag) {
+        if (hawkeye) {
+            hawkeyeUpdate(cacheBase, set, mruLine, numOfLines, 0);
+        }
+        return hitLine(cacheBase, mruLine, blockAddress, need, block);
+    }
+
+    /* iteratively use the tag to determine if block of memory
+     * that includes the address is in one of the lines in the set
+     */
+    for (int i = 0; i < numOfLines; i++) {
+        cache_line * line = &(set->cacheLineArray[i]);
+
+        // if the tag match and valid bit is 1, there is a cache hit
+        if (line->valid && line->tag == tag) {
+
+            // update all the line's time according to LRU rule (Hawkeye breaks ties by it), the other policies ignore hits
+            if (c_info.policy == CACHE_POLICY_LRU || hawkeye) {
+                setLRU(set, line, numOfLines);
+            }
+            if (hawkeye) {
+                hawkeyeUpdate(cacheBase, set, line, numOfLines, 0);
+            }
+            return hitLine(cacheBase, line, blockAddress, need, block);
+        }
+    }
+
+    /* if we didn't find any line hit, there's a cache miss, find an evictedLine according
+     * to the replacement policy, if the admission filter keeps it, the block bypasses the cache
+     */
+    unsigned int mask = allocationMask(cacheBase, numOfLines);
+    cache_line *evictedLine = hawkeye ? hawkeyeVictim(set, numOfLines, mask) : chooseVictim(set, numOfLines, mask);
+    if (!admit(cacheBase, tag, evictedLine)) {
+        return bypass(cacheBase, blockAddress, need, buffer, block);
+    }
+
+    /* Hawkeye evicting a cache-friendly line kept it too long, its region trains towards cache-averse, only in
+     * the sampled sets, so that this training and OPTgen's see the same share of the blocks
+     */
+    hawkeye_base * state = hawkeye ? hawkeyeOf(cacheBase) : 0;
+    if (state && evictedLine->valid && evictedLine->rrpv < RRPV_MAX &&
+        sampledSet(state, setIndex, numSets, evictedLine->tag) >= 0) {
+        train(state, evictedLine->tag, 0);
+    }
+    if (sectorOf(cacheBase)) {
+        dropSectors(cacheBase, sectorOf(cacheBase), evictedLine);
+    }
+    replaceLine(set, evictedLine, tag, numOfLines);
+    if (hawkeye) {
+        hawkeyeUpdate(cacheBase, set, evictedLine, numOfLines, 1);
+    }
+    if (c_info.policy == CACHE_POLICY_LRU && c_info.insertion != CACHE_INSERT_MRU &&
+        insertAtLRU(cacheBase, setIndex, numSets)) {
+        demote(set, evictedLine, numOfLines);
+    }
+
+    // load the block from memory into the evicted line, return 0 since we fail to find the value otherwise
+    return loadLine(cacheBase, evictedLine, blockAddress, need, block);
+}
+
+
+/* void function, re-derive the pointers stored in the fast memory after the fast memory has moved,
+ * e.g. when c_info.F_memory now points to a cache image restored from a checkpoint
+ * @params: none
+ * @return: none
+ */
+extern void cache_relocate() {
+
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+
+    // an image saved before the first access has no pointers yet, init() will set them up
+    if (cacheBase->initialized) {
+        setPointers(cacheBase);
+    }
+}
+
+
+/* unsigned int function, get the tags a lookup compares: every line of a fully associative cache, the ways of a
+ * set-associative one, or the tags of a compressed or deduplicated set, which has twice as many tags as ways
+ * @params: none
+ * @return: the tags, 0 before the first access
+ */
+extern unsigned int cache_probed_tags() {
+
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+    unsigned int numOfLines;
+    if (!cacheBase->initialized || !setCount(cacheBase, &numOfLines)) {
+        return 0;
+    }
+    return cacheBase->flags & (FLAG_COMPRESS | FLAG_DEDUP) ? 2 * numOfLines : numOfLines;
+}
+
+
+/* unsigned long function, get the id of the block that holds the byte at address,
+ * which is the tag the cache uses for it
+ * @params: unsigned long address: the address of the byte
+ * @return: the block id
+ */
+extern unsigned long cache_block_id(unsigned long address) {
+
+    unsigned long offset;   // offset of the address
+    unsigned long tag;      // tag of the address
+    address_decomposer(address, &offset, &tag);
+    return tag;
+}
+
+
+/* unsigned int function, get the policy selector of DIP, PSEL_MAX / 2 before the first access
+ * @params: none
+ * @return: the policy selector, BIP is chosen above half of its range
+ */
+extern unsigned int cache_get_psel() {
+
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+    return cacheBase->initialized ? cacheBase->psel : PSEL_MAX / 2;
+}
+
+
+/* void function, copy the bytes a cache with sector accounting loaded from main memory and the bytes of them it
+ * used: the referenced 8-byte words of the blocks that left the cache and of those still in it, both 0 without it
+ * @params: unsigned long long * fetched: where the bytes loaded are copied to
+ * @params: unsigned long long * used: where the bytes used are copied to
+ * @return: none
+ */
+extern void cache_get_sectors(unsigned long long *fetched, unsigned long long *used) {
+
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+    sector_base * sector = cacheBase->initialized ? sectorOf(cacheBase) : 0;
+
+    *fetched = sector ? sector->fetched : 0;
+    *used = sector ? sector->used : 0;
+    if (sector) {
+        unsigned int numOfLines;
+        unsigned long lines = setCount(cacheBase, &numOfLines) * (unsigned long) numOfLines;
+        cache_line * line = lines ? cacheBase->cacheSetArray[0].cacheLineArray : 0;
+        for (unsigned long i = 0; i < lines; i++) {
+            *used += line[i].valid ? 8 * __builtin_popcount(sector->touched[i]) : 0;
+        }
+    }
+}
+
+
+/* void function, copy the compression of a compressed cache: the blocks it compressed and their compressed bytes,
+ * and how many blocks it holds now against the lines of data it has, all 0 without compression
+ * @params: unsigned long long * fills: where the number of blocks compressed is copied to
+ * @params: unsigned long long * bytes: where their compressed bytes are copied to
+ * @params: unsigned int * resident: where the number of blocks the cache holds is copied to
+ * @params: unsigned int * lines: where the number of lines of data of the sets is copied to
+ * @return: none
+ */
+extern void cache_get_compression(unsigned long long *fills, unsigned long long *bytes, unsigned int *resident,
+                                  unsigned int *lines) {
+
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+    compress_base * compress = cacheBase->initialized ? compressOf(cacheBase) : 0;
+    unsigned int numOfLines;
+
+    *fills = compress ? compress->fills : 0;
+    *bytes = compress ? compress->bytes : 0;
+    *resident = compress ? cacheBase->validLines : 0;
+    *lines = compress ? setCount(cacheBase, &numOfLines) * numOfLines : 0;
+}
 
-/* void function, divide the address into tag and offset, according to the size of the block
- * @params: unsigned long address: the address that we want to divide
- * @params: unsigned long * offset: the offset value we want to get
- * @params: unsigned long * tag: the tag value we want to get
+
+/* void function, copy the deduplication statistics of a deduplicated cache, all 0 without deduplication
+ * @params: struct cache_dedup_stats * stats: where the statistics are copied to
  * @return: none
  */
-static void address_decomposer(unsigned long address, unsigned long * offset, unsigned long * tag) {
+extern void cache_get_dedup(struct cache_dedup_stats *stats) {
 
-    // compute the size of a single block (we will not access (cache_line*)0, just for size computation)
-    unsigned int sizeOfBlock = sizeof(((cache_line*)0)->cacheBlock);
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+    dedup_base * dedup = cacheBase->initialized ? dedupOf(cacheBase) : 0;
+
+    memset(stats, 0, sizeof(*stats));
+    if (dedup) {
+        unsigned int numOfLines;
+        stats->fills = dedup->fills;
+        stats->deduplicated = dedup->deduplicated;
+        stats->probes = dedup->probes;
+        stats->compares = dedup->compares;
+        stats->resident = cacheBase->validLines;
+        stats->distinct = dedup->distinct;
+        stats->lines = setCount(cacheBase, &numOfLines) * numOfLines;
+    }
+}
 
-    // compute the offsetBit according to the block size
-    unsigned char offsetBit = floor(log2(sizeOfBlock));
 
-    // compute the offset mask to get offset value from address
-    unsigned long offsetMask = ~(0xffffffffffffffff << offsetBit);
+/* void function, copy the relocation cost of a ZCache, both 0 for other caches
+ * @params: unsigned long long * relocations: where the number of blocks moved to another way is copied to
+ * @params: unsigned long long * candidates: where the number of replacement candidates walked is copied to
+ * @return: none
+ */
+extern void cache_get_relocations(unsigned long long *relocations, unsigned long long *candidates) {
 
-    *offset = address & offsetMask; // get the offset value from address
-    *tag = address >> offsetBit;    // right shift to get the tag value from address
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+    index_base * index = cacheBase->initialized ? indexOf(cacheBase) : 0;
+
+    *relocations = index ? index->relocations : 0;
+    *candidates = index ? index->candidates : 0;
 }
 
 
-/* void function, store a numOfElem-length data into valueTemp start from a specified location
- * @params: unsigned char valueTemp[8]: the value array we will store value into it
- * @params: unsigned char * block: the source block we want to take value from
- * @params: unsigned int numOfBlock: the number of elements we want to store into the valueTemp
- * @params: unsigned int startLocation: the start location where we want to store value to the valueTemp
+/* void function, copy the admission decisions of the TinyLFU filter, both 0 without a filter
+ * @params: unsigned long long * admitted: where the number of admitted blocks is copied to
+ * @params: unsigned long long * rejected: where the number of rejected blocks is copied to
  * @return: none
  */
-static void cache_get_byElem(unsigned char valueTemp[8], const unsigned char * block,
-                             unsigned int numOfElem, unsigned int startLocation) {
+extern void cache_get_admission(unsigned long long *admitted, unsigned long long *rejected) {
 
-    // iteratively store element from block to valueTemp start from startLocation
-    for (int i = 0; i < numOfElem; i++) {
-        valueTemp[i + startLocation] = block[i];
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+    struct tinylfu * sketch = cacheBase->initialized ? sketchOf(cacheBase) : 0;
+
+    *admitted = sketch ? sketch->admitted : 0;
+    *rejected = sketch ? sketch->rejected : 0;
+}
+
+
+/* int function, copy the statistics of one tenant of a shared cache, all 0 before the first access
+ * @params: unsigned int tenant: the tenant
+ * @params: struct cache_tenant_stats * stats: where the statistics are copied to
+ * @return: 1 on success and 0 if the cache has no such tenant
+ */
+extern int cache_get_tenant_stats(unsigned int tenant, struct cache_tenant_stats *stats) {
+
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!cacheBase->initialized) {
+        return tenant < c_info.tenants;
     }
+    tenant_base * tenants = tenantsOf(cacheBase);
+    if (!tenants || tenant >= cacheBase->tenants) {
+        return 0;
+    }
+
+    stats->stats = counters.tenant[tenant];
+    stats->evicted_by_others = tenants->tenant[tenant].evictedByOthers;
+    stats->occupancy = tenants->tenant[tenant].occupancy;
+    stats->way_mask = tenants->tenant[tenant].wayMask;
+    return 1;
 }
 
 
-/* unsigned long function, reverse the endian order of an unsigned long value which stored in
- * an unsigned char array, convert it to an unsigned long value and return
- * @params: unsigned char valueTemp[8]: the value stored in array which we want to reverse the order
- * @return: the value with reversed-order endian of the valueTemp
+/* void function, copy the statistics of the cache, all 0 before the first access
+ * @params: struct cache_stats * stats: where the statistics are copied to
+ * @return: none
  */
-static unsigned long reverse_endian(const unsigned char valueTemp[8]) {
+extern void cache_get_stats(struct cache_stats *stats) {
 
-    unsigned long value = 0;  // the value we will return, initialize it to 0
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
 
-    // iteratively move element from valueTemp to the value in reverse endian
-    for (int i = 0; i < 8; i++) {
-        value = (value << 8) | valueTemp[8 - i - 1];
+    if (cacheBase->initialized) {
+        *stats = counters.stats;
+    } else {
+        memset(stats, 0, sizeof(*stats));
     }
-    return value;
 }
 
 
-/* cache_line * function, find evict line by using LRU (least recently used) strategy:
- * take the line with the biggest time as evict line, add 1 to the time from all the other lines,
- * set the time of the evict line to be 0, update the tag with the given tag
- * @params: cache_set * set: the reference to our using set
- * @params: unsigned long tag: the new tag that we want to assign to the evict line
- * @params: unsigned int numOfLines: the number of cache lines depend on the size of the fast memory
- * @return: the evict line that we have to find
+/* void function, copy the statistics of the cache and of its tenants, e.g. to save them with a checkpoint
+ * @params: struct cache_counters * saved: where the statistics are copied to
+ * @return: none
  */
-static cache_line * findEvict(cache_set * set, unsigned long tag, unsigned int numOfLines) {
+extern void cache_get_counters(struct cache_counters *saved) {
 
-    struct cache_line *evictedLine;  // the evicted line that we have to find
+    *saved = counters;
+}
 
-    // iteratively find the evicted line with the biggest time
-    for (int i = 0; i < numOfLines; i++) {
-        if (set->cacheLineArray[i].time == (numOfLines - 1)) {
-            evictedLine = &set->cacheLineArray[i];
-        }
+
+/* void function, replace the statistics of the cache and of its tenants, e.g. after restoring a checkpoint
+ * @params: const struct cache_counters * saved: the statistics
+ * @return: none
+ */
+extern void cache_set_counters(const struct cache_counters *saved) {
+
+    counters = *saved;
+}
+
+
+/* void function, set all the statistics of the cache to 0, the cache content is unchanged
+ * @params: none
+ * @return: none
+ */
+extern void cache_reset_stats() {
+
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+
+    if (c_info.values) {
+        values_reset();
     }
+    if (cacheBase->initialized) {
+        memset(&counters, 0, sizeof(counters));
 
-    // iteratively add 1 to time from all the other lines
-    for (int i = 0; i < numOfLines; i++) {
-        if (set->cacheLineArray[i].time < evictedLine->time) {
-            set->cacheLineArray[i].time++;
+        tenant_base * tenants = tenantsOf(cacheBase);
+        for (unsigned int t = 0; tenants && t < cacheBase->tenants; t++) {
+            tenants->tenant[t].evictedByOthers = 0;
+        }
+
+        index_base * index = indexOf(cacheBase);
+        if (index) {
+            index->relocations = 0;
+            index->candidates = 0;
+        }
+
+        compress_base * compress = compressOf(cacheBase);
+        if (compress) {
+            compress->fills = 0;
+            compress->bytes = 0;
+        }
+
+        dedup_base * dedup = dedupOf(cacheBase);
+        if (dedup) {
+            dedup->fills = 0;
+            dedup->deduplicated = 0;
+            dedup->probes = 0;
+            dedup->compares = 0;
+        }
+
+        // the bytes of the resident blocks referenced so far don't count either
+        sector_base * sector = sectorOf(cacheBase);
+        if (sector) {
+            unsigned int numOfLines;
+            sector->fetched = 0;
+            sector->used = 0;
+            memset(sector->touched, 0, setCount(cacheBase, &numOfLines) * (unsigned long) numOfLines);
         }
     }
+}
 
-    evictedLine->tag = tag;  // update the tag
-    evictedLine->valid = 1;  // update the valid
-    evictedLine->time = 0;   // set time to 0, which is the most recently used
 
-    return evictedLine;
+/* void function, add the statistics of one part of a run (a thread, a process, an interval)
+ * to a total, the caller owns both, so no synchronization is needed
+ * @params: struct cache_stats * total: the statistics to add to
+ * @params: const struct cache_stats * part: the statistics to add
+ * @return: none
+ */
+extern void cache_stats_merge(struct cache_stats *total, const struct cache_stats *part) {
+
+    total->refs += part->refs;
+    total->hits += part->hits;
+    total->misses += part->misses;
+    total->fills += part->fills;
+    total->evictions += part->evictions;
 }
 
 
-/* void function, doing LRU (least recently used) step for the hit line:
- * add 1 to time from all the lines that less than this line's time,
- * set the line's time to be 0
- * @params: cache_set * set: the reference to our using set
- * @params: cache_line * line: the hit line
- * @params: unsigned int numOfLines: the number of cache lines depend on the size of the fast memory
+/* void function, compute the statistics of the part of a run between two snapshots
+ * @params: struct cache_stats * part: where the difference is stored
+ * @params: const struct cache_stats * end: the snapshot at the end of the part
+ * @params: const struct cache_stats * start: the snapshot at the start of the part
  * @return: none
  */
-static void setLRU(cache_set * set, cache_line * line, unsigned int numOfLines) {
+extern void cache_stats_diff(struct cache_stats *part, const struct cache_stats *end, const struct cache_stats *start) {
 
-    // iteratively add 1 to time from all the other lines that less than this line's time
-    for (int i = 0; i < numOfLines; i++) {
-        if (set->cacheLineArray[i].time < line->time) {
-            set->cacheLineArray[i].time++;
+    part->refs = end->refs - start->refs;
+    part->hits = end->hits - start->hits;
+    part->misses = end->misses - start->misses;
+    part->fills = end->fills - start->fills;
+    part->evictions = end->evictions - start->evictions;
+}
+
+
+/* void function, flush the cache: every line is invalidated, as on a context switch without ASIDs,
+ * the statistics and the replacement state are unchanged
+ * @params: none
+ * @return: none
+ */
+extern void cache_flush() {
+
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+    if (!cacheBase->initialized) {
+        return;
+    }
+
+    if (dedupOf(cacheBase)) {
+        emptyDedup(cacheBase);
+        return;
+    }
+
+    unsigned int numOfLines;
+    unsigned int numSets = setCount(cacheBase, &numOfLines);
+    sector_base * sector = sectorOf(cacheBase);
+    for (unsigned int s = 0; s < numSets; s++) {
+        if (compressOf(cacheBase)) {
+            compressedSet(cacheBase, s)->used = 0;
+            memset(compressedSet(cacheBase, s)->tags, 0, 2ul * numOfLines * sizeof(compressed_tag));
+            continue;
+        }
+        for (unsigned int i = 0; i < numOfLines; i++) {
+            if (sector) {
+                dropSectors(cacheBase, sector, &(cacheBase->cacheSetArray[s].cacheLineArray[i]));
+            }
+            cacheBase->cacheSetArray[s].cacheLineArray[i].valid = 0;
         }
     }
+    cacheBase->validLines = 0;
 
-    line->time = 0;  // set the line's time to be 0
+    tenant_base * tenants = tenantsOf(cacheBase);
+    for (unsigned int t = 0; tenants && t < cacheBase->tenants; t++) {
+        tenants->tenant[t].occupancy = 0;
+    }
 }
 
 
-/* void function, initialize the cache, set up all the pointers and structures,
- * include the cache base, cache set and cache line
+/* int function, check whether every line of the cache holds a block, a compressed or deduplicated cache is full
+ * once it holds as many blocks as it has lines of data, since it may hold more
  * @params: none
- * @return: none
+ * @return: 1 if the cache is full and 0 otherwise
  */
-static void init() {
+extern int cache_full() {
 
-    // the number of cache lines depend on the size of the fast memory
-    unsigned int numOfLines = (c_info.F_size - sizeof(cache_base) - sizeof(cache_set)) / sizeof(cache_line);
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+    unsigned int numOfLines;
+    return cacheBase->initialized && cacheBase->validLines >= setCount(cacheBase, &numOfLines) * numOfLines;
+}
 
-    /* initialization of the cache_base: create a pointer point to the start of the fast memory,
-     * set initialized flag to 1 which means the cache has been initialized, set the cache set array
-     * at the end of the cache base address
-     */
-    struct cache_base * cacheBase = c_info.F_memory;
-    cacheBase->initialized = 1;
-    cacheBase->cacheSetArray = (struct cache_set *) ((char *) cacheBase + sizeof(cache_base));
 
-    /* initialization of the cache_set: create a pointer point to the start of the cache set array,
-     * set the cache line array at the end of the cache set address
-     */
-    struct cache_set * cacheSet = &(cacheBase->cacheSetArray[0]);
-    cacheSet->cacheLineArray = (struct cache_line *) ((char *) cacheBase + sizeof(cache_base) + sizeof(cache_set));
+/* void function, hand a block cache_get reads to the value-locality analysis, unless the analysis is off or the
+ * cache is warming, the caller tells whether the block was loaded from main memory
+ * @params: cache_base * cacheBase: the cache base at the start of the fast memory
+ * @params: const unsigned char * block: the block
+ * @params: unsigned long blockAddress: the address of the first byte of the block
+ * @params: int hit: 1 if the block was found in the cache, 0 if it was loaded
+ * @return: none
+ */
+static void observe(cache_base * cacheBase, const unsigned char * block, unsigned long blockAddress, int hit) {
 
-    /* iteratively initialize each cache line: create a pointer point to the corresponding line address,
-     * initialize valid and tag to be 0 and set time increase 1 in order (for LRU)
-     */
-    for (int j = 0; j < numOfLines; j++) {
-        struct cache_line * cacheLine = &(cacheSet->cacheLineArray[j]);
-        cacheLine->time = j;
-        cacheLine->valid = 0;
-        cacheLine->tag = 0;
+    if (c_info.values && !cacheBase->warming) {
+        values_record(block, blockAddress, hit);
     }
 }
 
 
-/* int function, takes a memory address and a pointer to a value and loads a word
- * located at memory address and copies it into the location pointed to by value
+/* int function, load the word located at memory address through an initialized cache
+ * and copy it into the location pointed to by value
  * @params: unsigned long address: the location of the value to be loaded.
- *          Addresses are the memory references from the reference stream.
  * @params: unsigned long *value: a pointer to a buffer of where the word is to be copied into
  * @return: 1 on success and 0 on failure
  */
-extern int cache_get(unsigned long address, unsigned long *value) {
-
-    // the number of cache lines depend on the size of the fast memory
-    unsigned int numOfLines = (c_info.F_size - sizeof(cache_base) - sizeof(cache_set)) / sizeof(cache_line);
+static int lookup(unsigned long address, unsigned long *value) {
 
     // a char array temporarily hold the unsigned long value we want to return in reverse order
     unsigned char valueTemp[8] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
@@ -203,77 +2811,105 @@ extern int cache_get(unsigned long address, unsigned long *value) {
     // create the cacheBase, which contains an initialized flag and pointer to set array
     cache_base * cacheBase = (cache_base *)c_info.F_memory;
 
-    // check if the cache system has been initialized, if not, initialize the cache
-    if (!cacheBase->initialized) {
-        init();
-    }
+    // the number of cache sets and lines depend on the size of the fast memory
+    unsigned int numOfLines;
+    unsigned int numSets = setCount(cacheBase, &numOfLines);
 
+    // the TinyLFU filter sees every access, 0 without a filter
+    struct tinylfu * sketch = sketchOf(cacheBase);
 
     // break up the address into tag and offset
     unsigned long offset;   // offset of the address
     unsigned long tag;      // tag of the address
     address_decomposer(address, &offset, &tag);
+    tag = asidTag(cacheBase, tag);
+    if (sketch) {
+        tinylfu_record(sketch, tag);
+    }
 
-    // get the set we will use in the cache (there is only one set in our cache)
-    cache_set * set = &(cacheBase->cacheSetArray[0]);
+    // a fast memory too small for a single line can't cache anything, every word comes from main memory
+    if (numSets == 0) {
+        count_bypass(cacheBase);
+        if (!cacheBase->warming && !memget(address, valueTemp, 8)) {
+            return 0;
+        }
+        *value = reverse_endian(valueTemp);
+        return 1;
+    }
 
     // compute the size of a single block (we will not access (cache_line*)0, just for size computation)
     unsigned int sizeOfBlock = sizeof(((cache_line*)0)->cacheBlock);
 
+    // the tenant accounting, 0 without tenants
+    tenant_base * tenants = tenantsOf(cacheBase);
+
     /* if the offset is not in the last seven elements of the block, check the hit and miss as usual,
      * otherwise, the data will cross two lines of the cache, in this case we will check differently
      */
     if (offset + 8 <= sizeOfBlock) {
 
-        /* iteratively use the tag to determine if block of memory
-         * that includes the address is in one of the lines in the set
-         */
-        for (int i = 0; i < numOfLines; i++) {
-            cache_line * line = &(set->cacheLineArray[i]);
-
-            // if the tag match and valid bit is 1, there is a cache hit
-            if (line->valid && line->tag == tag) {
-
-                // update all the line's time according to LRU rule
-                setLRU(set, line, numOfLines);
-                // copy the word to valueTemp, the offset is used to locate the word in current line
-                cache_get_byElem(valueTemp, line->cacheBlock + offset, 8, 0);
-                // reverse the order of valueTemp and copy it to the value
-                *value = reverse_endian(valueTemp);
-                return 1;
-            }
+        // a block the admission filter rejects is loaded into the buffer
+        unsigned char buffer[64];
+        const unsigned char * block;
+        unsigned long long fills = counters.stats.fills;
+        if (!getBlock(cacheBase, tag, address - offset, numSets, numOfLines, 0xffULL << offset, buffer, &block)) {
+            return 0;
         }
+        observe(cacheBase, block, address - offset, counters.stats.fills == fills);
 
-        /* if we didn't find any line hit, there's a cache miss
-         * find an evictedLine according to the LRU rules
-         */
-        cache_line *evictedLine = findEvict(set, tag, numOfLines);
+        // copy the word to valueTemp, the offset is used to locate the word in the block
+        cache_get_byElem(valueTemp, block + offset, 8, 0);
+        // reverse the order of valueTemp and copy it to the value
+        *value = reverse_endian(valueTemp);
+        return 1;
 
-        /* if successfully load data from memory to cache, store value to the valueTemp,
-         * reverse the endian order, assign the value to *value, and return 1
-         * otherwise, return 0 since we fail to find the value
-         */
-        if (memget(address - offset, evictedLine->cacheBlock, 64)) {
 
-            // copy the word to valueTemp, the offset is used to locate the word in current line
-            cache_get_byElem(valueTemp, evictedLine->cacheBlock + offset, 8, 0);
-            // reverse the order of valueTemp and copy it to the value
-            *value = reverse_endian(valueTemp);
-            return 1;
+    /* if the two blocks are in different sets, the tenant may only fill some of the ways, the insertion
+     * policy may insert at the LRU position, Hawkeye ages the lines, the lines have sectors or the sets are
+     * compressed or deduplicated, look up the block of line1 and then the block of line2
+     */
+    } else if (numSets > 1 || (tenants && tenants->partitioned) || c_info.insertion != CACHE_INSERT_MRU ||
+               c_info.policy == CACHE_POLICY_HAWKEYE || indexOf(cacheBase) || sectorOf(cacheBase) ||
+               compressOf(cacheBase) || dedupOf(cacheBase)) {
+        unsigned long newAddress = address + (sizeOfBlock - offset);  // the expected line2 address
 
-        } else {
-            return 0;
+        // break up the new address into tag and offset
+        unsigned long newOffset = 0;    // offset of the new address
+        unsigned long newTag = 0;       // tag of the new address
+        address_decomposer(newAddress, &newOffset, &newTag);
+        newTag = asidTag(cacheBase, newTag);
+        if (sketch) {
+            tinylfu_record(sketch, newTag);
         }
 
+        unsigned char buffer[64];
+        const unsigned char * block;
+        unsigned long long fills = counters.stats.fills;
+        if (!getBlock(cacheBase, tag, address - offset, numSets, numOfLines, ~0ULL << offset, buffer, &block)) {
+            return 0;
+        }
+        observe(cacheBase, block, address - offset, counters.stats.fills == fills);
+        cache_get_byElem(valueTemp, block + offset, sizeOfBlock - offset, 0);
+        fills = counters.stats.fills;
+        if (!getBlock(cacheBase, newTag, newAddress - newOffset, numSets, numOfLines,
+                      (1ULL << (offset + 8 - sizeOfBlock)) - 1, buffer, &block)) {
+            return 0;
+        }
+        observe(cacheBase, block, newAddress - newOffset, counters.stats.fills == fills);
+        cache_get_byElem(valueTemp, block, 8 - (sizeOfBlock - offset), sizeOfBlock - offset);
 
+        // reverse the order of valueTemp and copy it to the value
+        *value = reverse_endian(valueTemp);
 
-    /* if the offset is the last seven elements of the block, check hit and miss in both lines of the cache
+    /* if the offset is the last seven elements of the block in a single set that every way of may be filled,
+     * check hit and miss in both lines of the cache
      * In the last of the line1, it stores the first several elements of the value
      * In the start of the line2, it stores the last several elements of the value
      */
     } else {
-        unsigned char isHitLine1 = 0;  // the hit flag represent whether line1 is hit
-        unsigned char isHitLine2 = 0;  // the hit flag represent whether line2 is hit
+
+        // get the set we will use in the cache (there is only one set in a fully associative cache)
+        cache_set * set = &(cacheBase->cacheSetArray[0]);
 
         unsigned long newAddress = address + (sizeOfBlock - offset);  // the expected line2 address
 
@@ -281,94 +2917,220 @@ extern int cache_get(unsigned long address, unsigned long *value) {
         unsigned long newOffset = 0;    // offset of the new address
         unsigned long newTag = 0;       // tag of the new address
         address_decomposer(newAddress, &newOffset, &newTag);
+        newTag = asidTag(cacheBase, newTag);
+        if (sketch) {
+            tinylfu_record(sketch, newTag);  // words crossing two lines are always admitted
+        }
+
+        cache_line * hitLine1 = 0;  // the line holding line1's tag, if line1 is hit
+        cache_line * hitLine2 = 0;  // the line holding line2's tag, if line2 is hit
+        cache_line * lruLine = 0;   // the least recently used line (time numOfLines - 1)
+        cache_line * lru2Line = 0;  // the second least recently used line (time numOfLines - 2)
 
-        // check whether line1 is hit, if hit, update part of the value (from line1) to the valueTemp
+        /* resolve both tags in a single scan, and remember the two least recently used lines
+         * on the way, since they are the only candidates the misses can evict
+         */
         for (int i = 0; i < numOfLines; i++) {
             cache_line * line = &(set->cacheLineArray[i]);
             if (line->valid && line->tag == tag) {
-
-                // update all the line's time according to LRU rule
-                setLRU(set, line, numOfLines);
-
-                /* copy part of the word to valueTemp, which start from offset, end to the end of the block
-                 * the offset is used to locate the word in current line. And the value will store from
-                 * the start of the valueTemp array
-                 */
-                cache_get_byElem(valueTemp, line->cacheBlock + offset,
-                                 sizeOfBlock - offset, 0);
-
-                isHitLine1 = 1;  // set line1's hit flag
-                break;
+                hitLine1 = line;
+            } else if (line->valid && line->tag == newTag) {
+                hitLine2 = line;
+            }
+            if (line->time == numOfLines - 1) {
+                lruLine = line;
+            } else if (line->time == numOfLines - 2) {
+                lru2Line = line;
             }
         }
+        if (lru2Line == 0) {
+            lru2Line = lruLine;  // a single line cache, both misses evict the same line
+        }
 
-        // check whether line2 is hit, if hit, update part of the value (from line2) to the valueTemp
-        for (int i = 0; i < numOfLines; i++) {
-            cache_line * line = &(set->cacheLineArray[i]);
-            if (line->valid && line->tag == newTag) {
-
-                // update all the line's time according to LRU rule
-                setLRU(set, line, numOfLines);
+        cache_line * line1 = hitLine1;  // the line that will hold line1's block
+        cache_line * line2 = hitLine2;  // the line that will hold line2's block
 
-                /* copy part of the word to valueTemp, which start from start of the block, end until
-                 * the char array is full. And the value will store from sizeOfBlock - offset since
-                 * elements before this index is from line1 part, elements after this index is line2 part.
-                 */
-                cache_get_byElem(valueTemp, line->cacheBlock,
-                                 8 - (sizeOfBlock - offset), sizeOfBlock-offset);
+        /* for LRU, pick the line1 and line2 lines, hits are touched before misses, so a miss evicts
+         * the least recently used line other than the hit line, and a double miss evicts
+         * the two least recently used lines in order. The other policies ignore hits and
+         * evict with findEvict below
+         */
+        if (c_info.policy == CACHE_POLICY_LRU) {
+            if (!hitLine1 && !hitLine2) {
+                line1 = lruLine;
+                line2 = lru2Line;
+            } else if (!hitLine1) {
+                line1 = (lruLine != hitLine2) ? lruLine : lru2Line;
+            } else if (!hitLine2) {
+                line2 = (lruLine != hitLine1) ? lruLine : lru2Line;
+            }
 
-                isHitLine2 = 1;  // set line2's hit flag
-                break;
+            // update LRU once for the pair, the line touched last becomes the most recently used
+            if (hitLine1 || !hitLine2) {
+                setLRUPair(set, line1, line2, numOfLines);
+            } else {
+                setLRUPair(set, line2, line1, numOfLines);
             }
         }
 
-        /* if the line1 not hit, there's a cache miss, find an evict line,
-         * get data from the main memory and store it to the line1, then
-         * store part of the data (last several elements) from cache to valueTemp
+        /* copy the parts of the word held by hit lines first, since with very few lines a miss may
+         * evict the other hit line. line1 part start from offset, end to the end of the block, and
+         * will store from the start of the valueTemp. line2 part start from the start of the block,
+         * and will store from sizeOfBlock - offset, after the line1 part
+         */
+        if (hitLine1 && hitLine1->valid == LINE_WARMED && !cacheBase->warming &&
+            !loadWarmed(cacheBase, hitLine1, address - offset)) {
+            return 0;
+        }
+        if (hitLine2 && hitLine2->valid == LINE_WARMED && !cacheBase->warming &&
+            !loadWarmed(cacheBase, hitLine2, newAddress - newOffset)) {
+            return 0;
+        }
+        if (hitLine1) {
+            observe(cacheBase, line1->cacheBlock, address - offset, 1);
+            cache_get_byElem(valueTemp, line1->cacheBlock + offset, sizeOfBlock - offset, 0);
+        }
+        if (hitLine2) {
+            observe(cacheBase, line2->cacheBlock, newAddress - newOffset, 1);
+            cache_get_byElem(valueTemp, line2->cacheBlock, 8 - (sizeOfBlock - offset), sizeOfBlock - offset);
+        }
+
+        /* if the line1 not hit, there's a cache miss, get data from the main memory and store it
+         * to the evicted line, then store part of the data (last several elements) from cache to valueTemp
+         * otherwise, return 0 since we fail to find the value
          */
-        if (isHitLine1 == 0) {
-
-            // find an evictedLine according to the LRU rules
-            cache_line *evictedLine = findEvict(set, tag, numOfLines);
-
-            /* get data from main memory to line1, if success, copy part of the
-             * word (last several elements) from line1 to valueTemp
-             * otherwise, return 0 since we fail to find the value
-             */
-            if(memget(address - offset, evictedLine->cacheBlock, sizeOfBlock)) {
-                cache_get_byElem(valueTemp, evictedLine->cacheBlock + offset,
-                                 sizeOfBlock - offset, 0);
+        if (!hitLine1) {
+            if (c_info.policy != CACHE_POLICY_LRU) {
+                line1 = findEvict(set, tag, numOfLines);
             } else {
+                count_fill(line1);
+            }
+            line1->tag = tag;
+            line1->valid = cacheBase->warming ? LINE_WARMED : 1;
+            if (!cacheBase->warming && !memget(address - offset, line1->cacheBlock, sizeOfBlock)) {
                 return 0;
             }
+            observe(cacheBase, line1->cacheBlock, address - offset, 0);
+            cache_get_byElem(valueTemp, line1->cacheBlock + offset, sizeOfBlock - offset, 0);
         }
 
-        /* if the line2 not hit, there's a cache miss, find an evict line,
-         * get data from the main memory and store it to the line2, then
-         * store part of the data (first several elements) from cache to valueTemp
+        /* if the line2 not hit, there's a cache miss, get data from the main memory and store it
+         * to the evicted line, then store part of the data (first several elements) from cache to valueTemp
+         * otherwise, return 0 since we fail to find the value
          */
-        if (isHitLine2 == 0) {
-
-            // find an evictedLine according to the LRU rules
-            cache_line *evictedLine = findEvict(set, newTag, numOfLines);
-
-            /* get data from main memory to line2, if success, copy part of the
-             * word (first several elements) from line2 to valueTemp
-             * otherwise, return 0 since we fail to find the value
-             */
-            if(memget(newAddress - newOffset, evictedLine->cacheBlock, sizeOfBlock)) {
-                cache_get_byElem(valueTemp, evictedLine->cacheBlock,
-                                 8 - (sizeOfBlock - offset), sizeOfBlock-offset);
+        if (!hitLine2) {
+            if (c_info.policy != CACHE_POLICY_LRU) {
+                line2 = findEvict(set, newTag, numOfLines);
             } else {
+                count_fill(line2);
+            }
+            line2->tag = newTag;
+            line2->valid = cacheBase->warming ? LINE_WARMED : 1;
+            if (!cacheBase->warming && !memget(newAddress - newOffset, line2->cacheBlock, sizeOfBlock)) {
                 return 0;
             }
+            observe(cacheBase, line2->cacheBlock, newAddress - newOffset, 0);
+            cache_get_byElem(valueTemp, line2->cacheBlock, 8 - (sizeOfBlock - offset), sizeOfBlock - offset);
         }
 
         // reverse the order of valueTemp and copy it to the value
         *value = reverse_endian(valueTemp);
     }
 
-    return 0;
+    return 1;
+}
+
+
+/* int function, takes a memory address and a pointer to a value and loads a word
+ * located at memory address and copies it into the location pointed to by value,
+ * the reference is a hit if no block had to be loaded from main memory
+ * @params: unsigned long address: the location of the value to be loaded.
+ *          Addresses are the memory references from the reference stream.
+ * @params: unsigned long *value: a pointer to a buffer of where the word is to be copied into
+ * @return: 1 on success and 0 on failure
+ */
+extern int cache_get(unsigned long address, unsigned long *value) {
+
+    // create the cacheBase, which contains an initialized flag and pointer to set array
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+
+    // check if the cache system has been initialized, if not, initialize the cache
+    if (!cacheBase->initialized) {
+        init();
+    }
+
+    unsigned long long fills = counters.stats.fills;  // the fills before this reference
+    int result = lookup(address, value);
+
+    // count the reference, it missed if it loaded any block from main memory
+    if (!cacheBase->warming) {
+        int hit = counters.stats.fills == fills;
+        counters.stats.refs++;
+        counters.stats.hits += hit;
+        counters.stats.misses += !hit;
+
+        // and count it for its tenant as well
+        tenant_base * tenants = tenantsOf(cacheBase);
+        if (tenants) {
+            struct cache_stats * stats = &(counters.tenant[currentTenant(cacheBase)]);
+            stats->refs++;
+            stats->hits += hit;
+            stats->misses += !hit;
+        }
+    }
+    count_access(cacheBase);
+    return result;
 }
 
 
+/* int function, functional warming: bring the block that holds the word at address into the cache and
+ * update the replacement state exactly as cache_get would, but without assembling the word. Only the tags
+ * are updated, a line a miss fills is marked LINE_WARMED and its block is loaded by the first cache_get
+ * that reads it. Compressed and deduplicated sets still load the block, where it goes depends on its data
+ * @params: unsigned long address: the location of the word
+ * @return: 1 on success and 0 on failure
+ */
+extern int cache_warm(unsigned long address) {
+
+    cache_base * cacheBase = (cache_base *)c_info.F_memory;
+
+    // the number of cache sets and lines depend on the size of the fast memory
+    unsigned int numOfLines = 0;
+    unsigned int numSets = cacheBase->initialized ? setCount(cacheBase, &numOfLines) : 0;
+
+    // break up the address into tag and offset
+    unsigned long offset;   // offset of the address
+    unsigned long tag;      // tag of the address
+    address_decomposer(address, &offset, &tag);
+    tag = asidTag(cacheBase, tag);
+
+    // compute the size of a single block (we will not access (cache_line*)0, just for size computation)
+    unsigned int sizeOfBlock = sizeof(((cache_line*)0)->cacheBlock);
+
+    // a cold cache, words crossing two lines and a cache without lines are rare, cache_get handles them
+    if (!cacheBase->initialized || offset + 8 > sizeOfBlock || numSets == 0) {
+        unsigned long value;
+        if (!cacheBase->initialized) {
+            init();
+        }
+        cacheBase->warming = 1;
+        int result = cache_get(address, &value);
+        cacheBase->warming = 0;
+        return result;
+    }
+
+    struct tinylfu * sketch = sketchOf(cacheBase);
+    if (sketch) {
+        tinylfu_record(sketch, tag);
+    }
+
+    /* a hit only changes the replacement state, a miss evicts a line and fills it with the tag, unless the
+     * admission filter keeps the line
+     */
+    const unsigned char * block;
+    cacheBase->warming = 1;
+    int result = getBlock(cacheBase, tag, address - offset, numSets, numOfLines, 0xffULL << offset, 0, &block);
+    cacheBase->warming = 0;
+    count_access(cacheBase);
+    return result;
+}
@@ -1,10 +1,145 @@
 #ifndef CACHE_CACHE_H
 #define CACHE_CACHE_H
 
+/* Replacement policies, selected by c_info.policy
+ *   CACHE_POLICY_LRU:    evict the least recently used line (the default)
+ *   CACHE_POLICY_FIFO:   evict the line that was filled first, hits do not change the order
+ *   CACHE_POLICY_RANDOM: evict a pseudo-random line
+ *   CACHE_POLICY_HAWKEYE: learn from Belady's OPT on sampled sets (OPTgen) which address regions are
+ *                        cache-friendly, and evict the blocks of cache-averse regions first. Its predictor
+ *                        lives in F_memory, so it must be the policy when the cache is initialized
+ */
+#define CACHE_POLICY_LRU     0
+#define CACHE_POLICY_FIFO    1
+#define CACHE_POLICY_RANDOM  2
+#define CACHE_POLICY_HAWKEYE 3
+
+/* Admission filters, selected by c_info.admission, which must not change from none to another
+ * value once the cache is initialized, since the filter lives in F_memory in front of the lines
+ *   CACHE_ADMISSION_NONE:    every missing block is filled (the default)
+ *   CACHE_ADMISSION_TRAIN:   keep the TinyLFU filter up to date, but still fill every block,
+ *                            so a run can switch to CACHE_ADMISSION_TINYLFU later (e.g. in a branch)
+ *   CACHE_ADMISSION_TINYLFU: fill a missing block only if it was accessed more often recently than
+ *                            the block it would evict, otherwise it bypasses the cache
+ */
+#define CACHE_ADMISSION_NONE    0
+#define CACHE_ADMISSION_TRAIN   1
+#define CACHE_ADMISSION_TINYLFU 2
+
+/* Insertion policies of the LRU policy, selected by c_info.insertion, the position a missing block takes
+ *   CACHE_INSERT_MRU: the most recently used position (the default, plain LRU)
+ *   CACHE_INSERT_LIP: the least recently used position, it only moves up on a hit
+ *   CACHE_INSERT_BIP: the LRU position, except for one block in 32 which goes to the MRU position
+ *   CACHE_INSERT_DIP: MRU or BIP insertion, whichever misses less on the sets (or blocks) dedicated to each,
+ *                     as counted by a saturating 10-bit policy selector (set dueling)
+ */
+#define CACHE_INSERT_MRU 0
+#define CACHE_INSERT_LIP 1
+#define CACHE_INSERT_BIP 2
+#define CACHE_INSERT_DIP 3
+
+/* Set index functions of a set-associative cache, selected by c_info.index, fixed once initialized
+ *   CACHE_INDEX_MODULO: the block id modulo the number of sets (the default)
+ *   CACHE_INDEX_XOR:    the block id with its higher bits XOR-folded onto the index bits, modulo the number of sets
+ *   CACHE_INDEX_PRIME:  the block id modulo the largest prime not above the number of sets
+ *   CACHE_INDEX_SKEW:   skewed associativity, every way hashes the block id to a set of its own,
+ *                       and the lines of a miss are replaced by their time stamps
+ *   CACHE_INDEX_ZCACHE: skewed ways, and a miss walks the lines the blocks of its candidates could move to,
+ *                       evicts the best of all of them and relocates the blocks on the way (ZCache)
+ */
+#define CACHE_INDEX_MODULO 0
+#define CACHE_INDEX_XOR    1
+#define CACHE_INDEX_PRIME  2
+#define CACHE_INDEX_SKEW   3
+#define CACHE_INDEX_ZCACHE 4
+
+/* Compressed caches, selected by c_info.compression, fixed once initialized: every set of a set-associative
+ * cache has twice as many tags as ways and the data of its ways, in 8-byte segments, and every filled block is
+ * stored compressed, so a set holds more blocks the better they compress
+ *   CACHE_COMPRESS_NONE: blocks are stored in lines of 64 bytes (the default)
+ *   CACHE_COMPRESS_BDI:  Base-Delta-Immediate compression
+ *   CACHE_COMPRESS_FPC:  Frequent Pattern Compression
+ *   CACHE_COMPRESS_BEST: both, the smaller result is kept
+ */
+#define CACHE_COMPRESS_NONE 0
+#define CACHE_COMPRESS_BDI  1
+#define CACHE_COMPRESS_FPC  2
+#define CACHE_COMPRESS_BEST 3
+
+/* Shared caches: with c_info.tenants set, every reference belongs to the tenant in c_info.tenant, and
+ * each tenant may only fill the ways set in its way mask (as with Intel CAT), hits are allowed in any way.
+ * Way masks need a set-associative cache of at most CACHE_MAX_WAYS ways.
+ */
+#define CACHE_MAX_TENANTS 8
+#define CACHE_MAX_WAYS    32
+
+/* The statistics of a cache, kept in its F_memory, all counters are 64 bits so they
+ * don't overflow on long traces
+ *   refs:      number of references (cache_get() calls)
+ *   hits:      references that didn't load any block from main memory
+ *   misses:    references that loaded at least one block from main memory
+ *   fills:     blocks loaded from main memory
+ *   evictions: fills that replaced a valid line
+ */
+struct cache_stats {
+    unsigned long long refs;
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long fills;
+    unsigned long long evictions;
+};
+
 struct cache_info {
     void *F_memory;          /* pointer to "fast" memory that can be used by the cache */
     unsigned int F_size;   /* amount of "fast" memory (in bytes) */
     unsigned int M_size;   /* amount of main memory (in bytes) */
+    unsigned int policy;   /* replacement policy, may be changed between accesses */
+    unsigned int admission; /* admission filter, see CACHE_ADMISSION_NONE */
+    unsigned int insertion; /* insertion policy of LRU, see CACHE_INSERT_MRU, may be changed between accesses */
+    unsigned int ways;     /* lines per set, 0 for a fully associative cache, fixed once initialized */
+    unsigned int index;    /* set index function of a set-associative cache, see CACHE_INDEX_MODULO */
+    unsigned int sectors;  /* sectors per line (1, 2, 4 or 8) with byte accounting, 0 for neither, fixed once initialized */
+    unsigned int compression; /* block compression of a set-associative cache, see CACHE_COMPRESS_NONE */
+    unsigned int dedup;    /* 1 to share the data of identical blocks in a set-associative cache, fixed once initialized */
+    unsigned int values;   /* the regions of the value-locality analysis of the blocks (values.h), 0 for none */
+    unsigned int tenants;  /* number of tenants sharing the cache, 0 for no accounting, fixed once initialized */
+    unsigned int tenant;   /* the tenant of the next reference, may be changed between accesses */
+    unsigned int way_mask[CACHE_MAX_TENANTS]; /* the ways each tenant may fill, 0 for all of them */
+    unsigned int ucp_interval; /* repartition the ways every ucp_interval references (UCP), 0 to keep way_mask */
+    unsigned int asid;     /* 1 to tag blocks with the tenant (ASID), so tenants never share blocks */
+};
+
+/* The statistics of one tenant of a shared cache
+ *   stats:             the references, hits, misses, fills and evictions of the tenant
+ *   evicted_by_others: the lines of the tenant that another tenant evicted
+ *   occupancy:         the lines that hold a block of the tenant
+ *   way_mask:          the ways the tenant may fill now
+ */
+struct cache_tenant_stats {
+    struct cache_stats stats;
+    unsigned long long evicted_by_others;
+    unsigned int occupancy;
+    unsigned int way_mask;
+};
+
+/* The deduplication of a cache with c_info.dedup: its sets have twice as many tags as ways, and the tags point
+ * into one pool of data entries, as many as the lines, where identical blocks share an entry
+ *   fills:        blocks loaded from main memory and hashed
+ *   deduplicated: fills whose contents an entry already held, they took no entry of their own
+ *   probes:       entries of the hash chains looked at by the fills
+ *   compares:     entries whose 64 bytes were compared with a filled block, because their hash matched
+ *   resident:     the tags that hold a block
+ *   distinct:     the entries in use, the distinct contents of the resident blocks
+ *   lines:        the data entries, the lines the cache would have without the extra tags
+ */
+struct cache_dedup_stats {
+    unsigned long long fills;
+    unsigned long long deduplicated;
+    unsigned long long probes;
+    unsigned long long compares;
+    unsigned int resident;
+    unsigned int distinct;
+    unsigned int lines;
 };
 
 /* The following global variable and function are provided by main.c
@@ -16,9 +151,13 @@ struct cache_info {
  *       buffer:  pointer to where the chunk of data from memory should be copied
  *       F_size:    F_size of the chunk in bytes
  *     Returns: 1 on success and 0 if address or (address + F_size) is out of range
+ *   mempeek() copies from "main memory" like memget(), but it isn't an access of main memory, so the
+ *     memory timing doesn't see it.  The cache uses it to load the block of a line that functional warming
+ *     filled with its tag only, on the first access that reads it.
  */
 extern struct cache_info c_info;
 extern unsigned int memget(unsigned int address, void *buffer, unsigned int size);
+extern unsigned int mempeek(unsigned int address, void *buffer, unsigned int size);
 
 /* This function is called from main()
  * It simulates a cache query for an 8 byte value.  It takes two parameters:
@@ -27,4 +166,77 @@ extern unsigned int memget(unsigned int address, void *buffer, unsigned int size
  * Returns: 1 on aucces and 0 if the address is not in range of value is NULL.
  */
 extern int cache_get(unsigned long address, unsigned long *value);
+
+/* This function is called from main() for references outside of the measured windows of a sampled run
+ * (functional warming).  It updates the tags and the replacement state exactly as cache_get() does for
+ * the same address, but does not return the word and does not load the block from main memory: a line it
+ * fills holds the tag only, and its block is loaded the first time cache_get() reads it, which is neither a
+ * miss nor a fill.  A compressed or deduplicated cache still loads the block, since where it goes depends
+ * on the data.
+ *   address: The address of the long value being referenced.
+ * Returns: 1 on success and 0 if the address is not in range.
+ */
+extern int cache_warm(unsigned long address);
+
+/* This function is called from main() after c_info.F_memory has been pointed at a copy of a cache
+ * image that was made at a different address (e.g. a checkpoint mapped from a file).
+ * It re-derives any pointers the cache keeps inside F_memory.  All other cache state must
+ * live in F_memory, so that copying F_memory copies the whole cache, except for its counters.
+ */
+extern void cache_relocate(void);
+
+/* The statistics of the cache and of its tenants.  They are kept outside of F_memory, so counting doesn't take
+ * any lines from the cache it measures, and a checkpoint saves them next to the F_memory image:
+ *   cache_get_counters() copies them
+ *   cache_set_counters() replaces them, e.g. with the counters of a restored checkpoint
+ */
+struct cache_counters {
+    struct cache_stats stats;
+    struct cache_stats tenant[CACHE_MAX_TENANTS];
+};
+extern void cache_get_counters(struct cache_counters *counters);
+extern void cache_set_counters(const struct cache_counters *counters);
+
+/* These functions are called from main() to observe the cache without changing it
+ *   cache_get_stats() copies the statistics of the cache into stats
+ *   cache_full() returns 1 once every line of the cache holds a block, 0 before
+ *   cache_block_id() returns the id of the block that holds the byte at address
+ *   cache_probed_tags() returns the tags a lookup compares, all the lines of a fully associative cache
+ *   cache_get_admission() copies the admission decisions of the TinyLFU filter, 0 without one
+ *   cache_get_sectors() copies the bytes loaded from main memory and the bytes of them referenced, 0 without sectors
+ *   cache_get_relocations() copies the blocks a ZCache relocated and the replacement candidates it walked, 0 otherwise
+ *   cache_get_compression() copies the compressed blocks filled and their bytes, and the blocks resident
+ *                           and the lines the cache would have without compression, 0 without compression
+ *   cache_get_dedup() copies the deduplication statistics, all 0 without deduplication
+ *   cache_get_psel() returns the policy selector of DIP, from 0 to 1023, above 511 BIP insertion is chosen
+ *   cache_get_tenant_stats() copies the statistics of one tenant, it returns 0 for an unknown tenant
+ * cache_reset_stats() sets the statistics (and those of the tenants and of the value analysis) to 0, e.g. at the
+ * end of a warmup window.
+ */
+extern void cache_get_stats(struct cache_stats *stats);
+extern void cache_reset_stats(void);
+extern int cache_full(void);
+extern unsigned long cache_block_id(unsigned long address);
+extern unsigned int cache_probed_tags(void);
+extern void cache_get_admission(unsigned long long *admitted, unsigned long long *rejected);
+extern unsigned int cache_get_psel(void);
+extern void cache_get_dedup(struct cache_dedup_stats *stats);
+extern void cache_get_relocations(unsigned long long *relocations, unsigned long long *candidates);
+extern void cache_get_sectors(unsigned long long *fetched, unsigned long long *used);
+extern void cache_get_compression(unsigned long long *fills, unsigned long long *bytes, unsigned int *resident,
+                                  unsigned int *lines);
+extern int cache_get_tenant_stats(unsigned int tenant, struct cache_tenant_stats *stats);
+
+/* This function is called from main() on a context switch when the cache has no ASIDs.
+ * It invalidates every line, the statistics are unchanged.
+ */
+extern void cache_flush(void);
+
+/* Helpers for statistics kept per run part (thread, process, interval) and combined afterwards:
+ *   cache_stats_merge() adds part to total
+ *   cache_stats_diff() stores end - start in part
+ * They only touch the structures they are given, so parts never share counters.
+ */
+extern void cache_stats_merge(struct cache_stats *total, const struct cache_stats *part);
+extern void cache_stats_diff(struct cache_stats *part, const struct cache_stats *end, const struct cache_stats *start);
 #endif //CACHE_CACHE_H
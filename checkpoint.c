@@ -0,0 +1,196 @@
+/**
+ * @author hongh233
+ * @description: This C program saves and restores the complete state of the cache to and from a file,
+ * so a cache can be warmed once and many experiments can be started from that state.
+ * Since the cache keeps all of its state except its statistics in the fast memory, a checkpoint
+ * is the fast memory image plus the statistics and the position in the trace.
+ */
+
+#include "cache.h"
+#include "checkpoint.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define CHECKPOINT_MAGIC "CACHEXCK"
+
+/* typedef struct checkpoint_config, the configuration of the cache a checkpoint was taken with. It decides the
+ * layout of the fast memory image and what the state in it means, so a checkpoint is only restored into the
+ * same configuration
+ * @params: unsigned int policy, admission, insertion: the replacement, admission and insertion policies
+ * @params: unsigned int ways, index, sectors: the lines per set, the set index function and the sectors per line
+ * @params: unsigned int compression, dedup: the block compression and the deduplication of the sets
+ * @params: unsigned int tenants, ucpInterval, asid: the tenants, their repartitioning by UCP and their ASID tags
+ * @params: unsigned int wayMask[CACHE_MAX_TENANTS]: the ways each tenant may fill
+ */
+typedef struct checkpoint_config {
+    unsigned int policy;
+    unsigned int admission;
+    unsigned int insertion;
+    unsigned int ways;
+    unsigned int index;
+    unsigned int sectors;
+    unsigned int compression;
+    unsigned int dedup;
+    unsigned int tenants;
+    unsigned int ucpInterval;
+    unsigned int asid;
+    unsigned int wayMask[CACHE_MAX_TENANTS];
+} checkpoint_config;
+
+/* typedef struct checkpoint_header, the header at the start of a checkpoint file
+ * @params: char magic[8]: identifies the file as a checkpoint, always CHECKPOINT_MAGIC
+ * @params: unsigned int version: the version of the file format, CHECKPOINT_VERSION
+ * @params: unsigned int imageOffset: where the fast memory image starts in the file, page aligned
+ * @params: unsigned int F_size: the size of the fast memory image
+ * @params: unsigned int M_size: the size of the main memory the cache was simulated with
+ * @params: checkpoint_config config: the configuration of the cache
+ * @params: struct checkpoint_state state: the simulation state kept outside of the fast memory
+ * @params: struct cache_counters counters: the statistics of the cache, also kept outside of the fast memory
+ */
+typedef struct checkpoint_header {
+    char magic[8];
+    unsigned int version;
+    unsigned int imageOffset;
+    unsigned int F_size;
+    unsigned int M_size;
+    checkpoint_config config;
+    struct checkpoint_state state;
+    struct cache_counters counters;
+} checkpoint_header;
+
+
+/* void function, get the configuration of the cache from c_info
+ * @params: checkpoint_config * config: where the configuration is stored
+ * @return: none
+ */
+static void get_config(checkpoint_config *config) {
+
+    memset(config, 0, sizeof(*config));
+    config->policy = c_info.policy;
+    config->admission = c_info.admission;
+    config->insertion = c_info.insertion;
+    config->ways = c_info.ways;
+    config->index = c_info.index;
+    config->sectors = c_info.sectors;
+    config->compression = c_info.compression;
+    config->dedup = c_info.dedup;
+    config->tenants = c_info.tenants;
+    config->ucpInterval = c_info.ucp_interval;
+    config->asid = c_info.asid;
+    memcpy(config->wayMask, c_info.way_mask, sizeof(config->wayMask));
+}
+
+
+/* unsigned int function, get the page size, a mapping offset must be a multiple of it
+ * @params: none
+ * @return: the page size in bytes
+ */
+static unsigned int page_size() {
+
+    long pageSize = sysconf(_SC_PAGESIZE);
+    return pageSize > 0 ? pageSize : 4096;
+}
+
+
+/* unsigned int function, compute where the fast memory image starts in the file:
+ * the header size rounded up to the page size, so the image can be mapped
+ * @params: none
+ * @return: the offset of the image in the file
+ */
+static unsigned int image_offset() {
+
+    unsigned int pageSize = page_size();
+    return (sizeof(checkpoint_header) + pageSize - 1) / pageSize * pageSize;
+}
+
+
+/* int function, save the fast memory and the simulation state to a checkpoint file
+ * @params: const char * path: the file to write
+ * @params: const struct checkpoint_state * state: the simulation state to save with the image
+ * @return: 1 on success and 0 on failure
+ */
+extern int checkpoint_save(const char *path, const struct checkpoint_state *state) {
+
+    // fill the header, which is padded with 0s up to the image
+    checkpoint_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.imageOffset = image_offset();
+    header.F_size = c_info.F_size;
+    header.M_size = c_info.M_size;
+    get_config(&header.config);
+    header.state = *state;
+    cache_get_counters(&header.counters);
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return 0;
+    }
+
+    // write the header, the padding and the fast memory image
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (unsigned int i = sizeof(header); ok && i < header.imageOffset; i++) {
+        ok = fputc(0, file) != EOF;
+    }
+    ok = ok && fwrite(c_info.F_memory, 1, c_info.F_size, file) == c_info.F_size;
+
+    // the data is only safe once the file has been closed successfully
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    return ok;
+}
+
+
+/* int function, restore the fast memory and the simulation state from a checkpoint file,
+ * the image is mapped copy-on-write, and read into c_info.F_memory only if it can't be mapped
+ * @params: const char * path: the file to read
+ * @params: struct checkpoint_state * state: where the saved simulation state is copied to
+ * @return: 1 on success and 0 on failure
+ */
+extern int checkpoint_restore(const char *path, struct checkpoint_state *state) {
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    // read and check the header, the checkpoint must be of this version and this configuration
+    checkpoint_header header;
+    checkpoint_config config;
+    get_config(&config);
+    if (read(fd, &header, sizeof(header)) != sizeof(header)
+        || memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != CHECKPOINT_VERSION
+        || header.F_size != c_info.F_size
+        || header.M_size != c_info.M_size
+        || memcmp(&header.config, &config, sizeof(config)) != 0) {
+        close(fd);
+        return 0;
+    }
+
+    /* map the image privately, so the cache can modify it without changing the file,
+     * pages are only copied when the cache writes to them
+     */
+    void *image = MAP_FAILED;
+    if (header.imageOffset % page_size() == 0) {
+        image = mmap(0, header.F_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, header.imageOffset);
+    }
+
+    if (image != MAP_FAILED) {
+        c_info.F_memory = image;
+    } else if (pread(fd, c_info.F_memory, header.F_size, header.imageOffset) != header.F_size) {
+        close(fd);
+        return 0;
+    }
+    close(fd);  // the mapping stays valid after the file is closed
+
+    cache_relocate();
+    cache_set_counters(&header.counters);
+    *state = header.state;
+    return 1;
+}
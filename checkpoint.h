@@ -0,0 +1,35 @@
+#ifndef CACHE_CHECKPOINT_H
+#define CACHE_CHECKPOINT_H
+
+/* The version of the checkpoint file format, bump it whenever the header or the
+ * layout of the cache in F_memory changes, so that stale checkpoints are rejected.
+ */
+#define CHECKPOINT_VERSION 11
+
+/* The simulation state that lives outside of F_memory and is saved with it
+ * (the statistics of the cache are saved with it too, see cache_get_counters()):
+ *   refs:   number of references simulated before the checkpoint was taken
+ */
+struct checkpoint_state {
+    unsigned long refs;
+};
+
+/* Saves the complete cache (c_info.F_memory, which holds all policy state, and its counters) and the state to a file.
+ * The F_memory image is stored page aligned after the header so it can be mapped back directly.
+ *   path:  the file to write
+ *   state: the simulation state to save with the image
+ * Returns: 1 on success and 0 on failure
+ */
+extern int checkpoint_save(const char *path, const struct checkpoint_state *state);
+
+/* Restores a cache saved by checkpoint_save().  The F_memory image is mapped copy-on-write from
+ * the file, so restoring costs the same no matter how large the cache is; c_info.F_memory is pointed
+ * at the mapped image, the cache's pointers are relocated and its counters are restored.  c_info.F_size, c_info.M_size and the
+ * configuration of the cache (policies, ways, index, sectors, compression, dedup and tenants) must match the
+ * values the checkpoint was taken with.
+ *   path:  the file to read
+ *   state: where the saved simulation state is copied to
+ * Returns: 1 on success and 0 on failure
+ */
+extern int checkpoint_restore(const char *path, struct checkpoint_state *state);
+#endif //CACHE_CHECKPOINT_H
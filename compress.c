@@ -0,0 +1,326 @@
+/**
+ * @author hongh233
+ * @description: This C program will implement the two block compression algorithms of the compressed cache,
+ * Base-Delta-Immediate (BDI) and Frequent Pattern Compression (FPC). Both only need shifts, adds and compares
+ * on the values of a single 64-byte block, so a fill pays a few hundred simple instructions for them.
+ */
+
+#include "compress.h"
+#include <string.h>
+
+#define BDI_ZEROS    0  // BDI encoding of an all-zero block, nothing but the encoding byte
+#define BDI_REPEATED 1  // BDI encoding of one repeated 8-byte value
+#define BDI_DELTAS   2  // the first BDI base-delta encoding, the others follow in the order of bdiSizes
+
+#define FPC_ZERO_RUN 0  // FPC prefixes of the patterns of a 32-bit word
+#define FPC_NIBBLE   1
+#define FPC_BYTE     2
+#define FPC_HALF     3
+#define FPC_PADDED   4
+#define FPC_BYTES    5
+#define FPC_REPEATED 6
+#define FPC_WORD     7
+
+/* the base and delta sizes of the base-delta encodings of BDI, smallest compressed size first */
+static const unsigned char bdiSizes[][2] = {{8, 1}, {4, 1}, {8, 2}, {2, 1}, {4, 2}, {8, 4}};
+
+
+/* unsigned long long function, read a little-endian value from a block
+ * @params: const unsigned char * bytes: the first byte of the value
+ * @params: unsigned int size: the bytes of the value, at most 8
+ * @return: the value
+ */
+static unsigned long long load(const unsigned char * bytes, unsigned int size) {
+
+    unsigned long long value = 0;
+    for (unsigned int i = size; i > 0; i--) {
+        value = (value << 8) | bytes[i - 1];
+    }
+    return value;
+}
+
+
+/* void function, write a value to a block in little-endian order
+ * @params: unsigned char * bytes: where the first byte of the value goes
+ * @params: unsigned long long value: the value
+ * @params: unsigned int size: the bytes of the value, at most 8
+ * @return: none
+ */
+static void store(unsigned char * bytes, unsigned long long value, unsigned int size) {
+
+    for (unsigned int i = 0; i < size; i++) {
+        bytes[i] = value >> (8 * i);
+    }
+}
+
+
+/* long long function, sign-extend the low bits of a value
+ * @params: unsigned long long value: the value
+ * @params: unsigned int bits: the bits the value has, at most 64
+ * @return: the sign-extended value
+ */
+static long long extend(unsigned long long value, unsigned int bits) {
+
+    if (bits >= 64) {
+        return (long long) value;
+    }
+    unsigned long long sign = 1ULL << (bits - 1);
+    value &= (sign << 1) - 1;
+    return (long long) ((value ^ sign) - sign);
+}
+
+
+/* int function, check whether the difference of two values of a width fits a signed delta of some bytes
+ * @params: unsigned long long value: the value
+ * @params: unsigned long long base: the base it is a delta from
+ * @params: unsigned int size: the bytes of the values
+ * @params: unsigned int deltaSize: the bytes of the delta
+ * @return: 1 if the delta fits and 0 otherwise
+ */
+static int fits(unsigned long long value, unsigned long long base, unsigned int size, unsigned int deltaSize) {
+
+    long long delta = extend(value - base, 8 * size);
+    long long limit = 1LL << (8 * deltaSize - 1);
+    return delta >= -limit && delta < limit;
+}
+
+
+/* unsigned int function, compress a block with one base-delta encoding of BDI: the base is the first value
+ * that isn't a small immediate, then every value is a delta from the base or from zero
+ * @params: const unsigned char * block: the block
+ * @params: unsigned int encoding: the index of the encoding in bdiSizes
+ * @params: unsigned char * out: where the compressed form goes
+ * @return: the compressed size, COMPRESS_BLOCK if the encoding doesn't fit the block
+ */
+static unsigned int bdiDeltas(const unsigned char * block, unsigned int encoding, unsigned char * out) {
+
+    unsigned int size = bdiSizes[encoding][0];       // the bytes of a value
+    unsigned int deltaSize = bdiSizes[encoding][1];  // the bytes of a delta
+    unsigned int values = COMPRESS_BLOCK / size;
+    unsigned char * mask = out + 1 + size;           // a bit per value, set if its delta is from the base
+    unsigned char * deltas = mask + values / 8;
+
+    unsigned long long base = 0;
+    int haveBase = 0;
+    memset(mask, 0, values / 8);
+    for (unsigned int i = 0; i < values; i++) {
+        unsigned long long value = load(block + i * size, size);
+        if (fits(value, 0, size, deltaSize)) {
+            store(deltas + i * deltaSize, value, deltaSize);
+            continue;
+        }
+        if (!haveBase) {
+            base = value;
+            haveBase = 1;
+        }
+        if (!fits(value, base, size, deltaSize)) {
+            return COMPRESS_BLOCK;
+        }
+        mask[i / 8] |= 1 << (i % 8);
+        store(deltas + i * deltaSize, value - base, deltaSize);
+    }
+    out[0] = BDI_DELTAS + encoding;
+    store(out + 1, base, size);
+    return 1 + size + values / 8 + values * deltaSize;
+}
+
+
+/* unsigned int function, compress a block with BDI, with the smallest encoding that fits it
+ * @params: const unsigned char * block: the block
+ * @params: unsigned char * out: where the compressed form goes, COMPRESS_BLOCK bytes
+ * @return: the compressed size, COMPRESS_BLOCK if the block doesn't compress
+ */
+extern unsigned int bdi_compress(const unsigned char *block, unsigned char *out) {
+
+    unsigned long long first = load(block, 8);
+    int repeated = 1;
+    for (unsigned int i = 8; i < COMPRESS_BLOCK && repeated; i += 8) {
+        repeated = load(block + i, 8) == first;
+    }
+    if (repeated) {
+        out[0] = first ? BDI_REPEATED : BDI_ZEROS;
+        store(out + 1, first, 8);
+        return first ? 9 : 1;
+    }
+
+    // the encodings are in order of their size, the first that fits is the smallest
+    for (unsigned int e = 0; e < sizeof(bdiSizes) / sizeof(bdiSizes[0]); e++) {
+        unsigned int size = bdiDeltas(block, e, out);
+        if (size < COMPRESS_BLOCK) {
+            return size;
+        }
+    }
+    return COMPRESS_BLOCK;
+}
+
+
+/* void function, restore a block compressed by bdi_compress
+ * @params: const unsigned char * in: the compressed form
+ * @params: unsigned char * block: where the block goes
+ * @return: none
+ */
+extern void bdi_decompress(const unsigned char *in, unsigned char *block) {
+
+    if (in[0] == BDI_ZEROS || in[0] == BDI_REPEATED) {
+        unsigned long long value = in[0] == BDI_ZEROS ? 0 : load(in + 1, 8);
+        for (unsigned int i = 0; i < COMPRESS_BLOCK; i += 8) {
+            store(block + i, value, 8);
+        }
+        return;
+    }
+
+    unsigned int size = bdiSizes[in[0] - BDI_DELTAS][0];
+    unsigned int deltaSize = bdiSizes[in[0] - BDI_DELTAS][1];
+    unsigned int values = COMPRESS_BLOCK / size;
+    unsigned long long base = load(in + 1, size);
+    const unsigned char * mask = in + 1 + size;
+    const unsigned char * deltas = mask + values / 8;
+
+    for (unsigned int i = 0; i < values; i++) {
+        long long delta = extend(load(deltas + i * deltaSize, deltaSize), 8 * deltaSize);
+        unsigned long long from = (mask[i / 8] >> (i % 8)) & 1 ? base : 0;
+        store(block + i * size, from + (unsigned long long) delta, size);
+    }
+}
+
+
+/* typedef struct bits, represent a bit stream in a compressed form of FPC, least significant bit first
+ * @params: unsigned char * bytes: the bytes of the stream
+ * @params: unsigned int position: the next bit
+ */
+typedef struct bits {
+    unsigned char * bytes;
+    unsigned int position;
+} bits;
+
+
+/* int function, append bits to a stream, unless it would grow to a whole block
+ * @params: bits * stream: the stream
+ * @params: unsigned int value: the bits
+ * @params: unsigned int count: the number of bits, at most 32
+ * @return: 1 on success and 0 if the stream is full
+ */
+static int put(bits * stream, unsigned int value, unsigned int count) {
+
+    if (stream->position + count >= 8 * COMPRESS_BLOCK) {
+        return 0;
+    }
+    for (unsigned int i = 0; i < count; i++, stream->position++) {
+        unsigned char bit = 1 << (stream->position % 8);
+        if ((value >> i) & 1) {
+            stream->bytes[stream->position / 8] |= bit;
+        } else {
+            stream->bytes[stream->position / 8] &= ~bit;
+        }
+    }
+    return 1;
+}
+
+
+/* unsigned int function, read bits from a stream
+ * @params: bits * stream: the stream
+ * @params: unsigned int count: the number of bits, at most 32
+ * @return: the bits
+ */
+static unsigned int get(bits * stream, unsigned int count) {
+
+    unsigned int value = 0;
+    for (unsigned int i = 0; i < count; i++, stream->position++) {
+        value |= (unsigned int) ((stream->bytes[stream->position / 8] >> (stream->position % 8)) & 1) << i;
+    }
+    return value;
+}
+
+
+/* unsigned int function, compress a block with FPC, word by word
+ * @params: const unsigned char * block: the block
+ * @params: unsigned char * out: where the compressed form goes, COMPRESS_BLOCK bytes
+ * @return: the compressed size, COMPRESS_BLOCK if the block doesn't compress
+ */
+extern unsigned int fpc_compress(const unsigned char *block, unsigned char *out) {
+
+    bits stream = {out, 0};
+    unsigned int words = COMPRESS_BLOCK / 4;
+
+    for (unsigned int i = 0; i < words; i++) {
+        unsigned int word = load(block + 4 * i, 4);
+        long long value = extend(word, 32);
+        int ok;
+
+        if (word == 0) {
+            unsigned int run = 1;  // the zero words from this one on, at most 8
+            while (run < 8 && i + run < words && load(block + 4 * (i + run), 4) == 0) {
+                run++;
+            }
+            ok = put(&stream, FPC_ZERO_RUN, 3) && put(&stream, run - 1, 3);
+            i += run - 1;
+        } else if (value >= -8 && value < 8) {
+            ok = put(&stream, FPC_NIBBLE, 3) && put(&stream, word, 4);
+        } else if (value >= -128 && value < 128) {
+            ok = put(&stream, FPC_BYTE, 3) && put(&stream, word, 8);
+        } else if (value >= -32768 && value < 32768) {
+            ok = put(&stream, FPC_HALF, 3) && put(&stream, word, 16);
+        } else if ((word & 0xffff) == 0) {
+            ok = put(&stream, FPC_PADDED, 3) && put(&stream, word >> 16, 16);
+        } else if (extend(word & 0xffff, 16) >= -128 && extend(word & 0xffff, 16) < 128 &&
+                   extend(word >> 16, 16) >= -128 && extend(word >> 16, 16) < 128) {
+            ok = put(&stream, FPC_BYTES, 3) && put(&stream, (word & 0xff) | ((word >> 8) & 0xff00), 16);
+        } else if (word == (word & 0xff) * 0x01010101u) {
+            ok = put(&stream, FPC_REPEATED, 3) && put(&stream, word & 0xff, 8);
+        } else {
+            ok = put(&stream, FPC_WORD, 3) && put(&stream, word, 32);
+        }
+        if (!ok) {
+            return COMPRESS_BLOCK;
+        }
+    }
+    return (stream.position + 7) / 8;
+}
+
+
+/* void function, restore a block compressed by fpc_compress
+ * @params: const unsigned char * in: the compressed form
+ * @params: unsigned char * block: where the block goes
+ * @return: none
+ */
+extern void fpc_decompress(const unsigned char *in, unsigned char *block) {
+
+    bits stream = {(unsigned char *) in, 0};
+    unsigned int words = COMPRESS_BLOCK / 4;
+
+    for (unsigned int i = 0; i < words; i++) {
+        unsigned int word = 0;
+        switch (get(&stream, 3)) {
+        case FPC_ZERO_RUN: {
+            unsigned int run = get(&stream, 3) + 1;
+            memset(block + 4 * i, 0, 4 * run);
+            i += run - 1;
+            continue;
+        }
+        case FPC_NIBBLE:
+            word = (unsigned int) extend(get(&stream, 4), 4);
+            break;
+        case FPC_BYTE:
+            word = (unsigned int) extend(get(&stream, 8), 8);
+            break;
+        case FPC_HALF:
+            word = (unsigned int) extend(get(&stream, 16), 16);
+            break;
+        case FPC_PADDED:
+            word = get(&stream, 16) << 16;
+            break;
+        case FPC_BYTES: {
+            unsigned int halves = get(&stream, 16);
+            word = ((unsigned int) extend(halves & 0xff, 8) & 0xffff) |
+                   ((unsigned int) extend(halves >> 8, 8) << 16);
+            break;
+        }
+        case FPC_REPEATED:
+            word = get(&stream, 8) * 0x01010101u;
+            break;
+        default:
+            word = get(&stream, 32);
+        }
+        store(block + 4 * i, word, 4);
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef CACHE_COMPRESS_H
+#define CACHE_COMPRESS_H
+
+/* Cache block compression.  Both algorithms work on a 64-byte block, read as little-endian values
+ * (the byte order the cache returns words in), and write at most 64 bytes: a block that would not
+ * get smaller is reported with a size of 64 and should be kept uncompressed.  The compressed
+ * form holds everything needed to decompress it, the caller only keeps its size.
+ *
+ *   Base-Delta-Immediate (BDI): the block is split into 8, 4 or 2-byte values, each stored as a
+ *   small delta from one base taken from the block or from zero (an immediate), with a bit per value
+ *   telling which.  All-zero blocks and blocks of one repeated 8-byte value have their own encodings.
+ *
+ *   Frequent Pattern Compression (FPC): every 32-bit word gets a 3-bit prefix for the pattern it
+ *   matches (a run of zero words, a sign-extended 4-bit, 8-bit or 16-bit value, a halfword padded
+ *   with zeros, two sign-extended bytes, a repeated byte) and only the bits the pattern needs.
+ */
+#define COMPRESS_BLOCK 64
+
+/* Compresses block with BDI into out (COMPRESS_BLOCK bytes).
+ * Returns the compressed size in bytes, COMPRESS_BLOCK if the block doesn't compress.
+ */
+extern unsigned int bdi_compress(const unsigned char *block, unsigned char *out);
+
+/* Restores the block of a compressed form made by bdi_compress. */
+extern void bdi_decompress(const unsigned char *in, unsigned char *block);
+
+/* Compresses block with FPC into out (COMPRESS_BLOCK bytes).
+ * Returns the compressed size in bytes, COMPRESS_BLOCK if the block doesn't compress.
+ */
+extern unsigned int fpc_compress(const unsigned char *block, unsigned char *out);
+
+/* Restores the block of a compressed form made by fpc_compress. */
+extern void fpc_decompress(const unsigned char *in, unsigned char *block);
+#endif //CACHE_COMPRESS_H
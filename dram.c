@@ -0,0 +1,277 @@
+/**
+ * @author hongh233
+ * @description: This C program will implement a DRAM timing model for the blocks the cache loads from main
+ * memory: channels, ranks and banks with row buffers, an open or closed page policy, and a memory controller
+ * that schedules the outstanding misses FR-FCFS. It only keeps time, memget() still copies the data.
+ */
+
+#include "dram.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOCK_BYTES 64  // the bytes of a request
+
+/* typedef struct bank, represent one bank of a rank
+ * @params: long long openRow: the row in the row buffer, -1 for none
+ * @params: unsigned long long ready: the cycle the bank can start the next request
+ */
+typedef struct bank {
+    long long openRow;
+    unsigned long long ready;
+} bank;
+
+/* typedef struct request, represent a request waiting for the memory controller
+ * @params: unsigned long long arrival: the cycle the core issued it
+ * @params: unsigned int channel: the channel of the block
+ * @params: unsigned int bankIndex: the bank of the block, counted over all the channels and ranks
+ * @params: long long row: the row of the block
+ */
+typedef struct request {
+    unsigned long long arrival;
+    unsigned int channel;
+    unsigned int bankIndex;
+    long long row;
+} request;
+
+static struct dram_config config;            // the organization, config.queue is 0 before dram_init
+static bank * banks;                         // the banks of all the channels and ranks
+static unsigned long long * busFree;         // the cycle the data bus of each channel is free
+static unsigned long long now;               // the cycle of the core
+static request waiting[DRAM_MAX_QUEUE];      // the requests not scheduled yet, oldest first
+static unsigned int numWaiting;
+static unsigned long long done[DRAM_MAX_QUEUE]; // the cycles the scheduled requests still in flight complete
+static unsigned int numDone;
+static struct dram_stats stats;
+static unsigned long long startCycle;        // the cycle the statistics were last reset
+
+
+/* int function, set up an idle DRAM
+ * @params: const struct dram_config * dram: the organization
+ * @return: 1 on success and 0 on failure
+ */
+extern int dram_init(const struct dram_config *dram) {
+
+    if (!dram->channels || !dram->ranks || !dram->banks || !dram->queue || dram->queue > DRAM_MAX_QUEUE) {
+        return 0;
+    }
+    unsigned int count = dram->channels * dram->ranks * dram->banks;
+    banks = malloc(count * sizeof(bank));
+    busFree = calloc(dram->channels, sizeof(unsigned long long));
+    if (!banks || !busFree) {
+        return 0;
+    }
+    for (unsigned int i = 0; i < count; i++) {
+        banks[i].openRow = -1;
+        banks[i].ready = 0;
+    }
+    config = *dram;
+    return 1;
+}
+
+
+/* unsigned long long function, get the first cycle a waiting request could start, once it arrived and its bank
+ * is ready
+ * @params: const request * waitingRequest: the request
+ * @return: the cycle
+ */
+static unsigned long long startOf(const request * waitingRequest) {
+
+    unsigned long long ready = banks[waitingRequest->bankIndex].ready;
+    return ready > waitingRequest->arrival ? ready : waitingRequest->arrival;
+}
+
+
+/* void function, schedule one waiting request FR-FCFS: of the requests that can start first, a row hit goes
+ * before the others, otherwise the oldest. Its bank and the data bus of its channel are taken until it is done
+ * @params: none
+ * @return: none
+ */
+static void schedule() {
+
+    unsigned long long decision = startOf(&waiting[0]);  // the first cycle any request can start
+    for (unsigned int i = 1; i < numWaiting; i++) {
+        unsigned long long start = startOf(&waiting[i]);
+        decision = start < decision ? start : decision;
+    }
+    unsigned int pick = numWaiting;
+    for (unsigned int i = 0; i < numWaiting; i++) {
+        if (startOf(&waiting[i]) > decision) {
+            continue;
+        }
+        if (pick == numWaiting) {
+            pick = i;
+        }
+        if (banks[waiting[i].bankIndex].openRow == waiting[i].row) {
+            pick = i;
+            break;
+        }
+    }
+
+    request chosen = waiting[pick];
+    memmove(&waiting[pick], &waiting[pick + 1], (numWaiting - pick - 1) * sizeof(request));
+    numWaiting--;
+
+    // the row buffer decides the commands the request needs
+    bank * target = &banks[chosen.bankIndex];
+    unsigned long long access = DRAM_T_CAS;
+    unsigned int kind = 0;  // a row hit, an empty bank or a row conflict
+    if (target->openRow < 0) {
+        access += DRAM_T_RCD;
+        kind = 1;
+    } else if (target->openRow != chosen.row) {
+        access += DRAM_T_RP + DRAM_T_RCD;
+        kind = 2;
+    }
+    unsigned long long transfer = decision + access;
+    transfer = transfer > busFree[chosen.channel] ? transfer : busFree[chosen.channel];
+    unsigned long long end = transfer + DRAM_T_BURST;
+    busFree[chosen.channel] = end;
+
+    // an open row takes the next column command after this burst, a closed row is precharged after it
+    if (config.page == DRAM_PAGE_OPEN) {
+        target->openRow = chosen.row;
+        target->ready = decision + access - DRAM_T_CAS + DRAM_T_BURST;
+    } else {
+        target->openRow = -1;
+        target->ready = end + DRAM_T_RP;
+    }
+
+    done[numDone++] = end;
+
+    // a request issued before the statistics were reset isn't counted
+    if (chosen.arrival < startCycle) {
+        return;
+    }
+    *(kind == 0 ? &stats.row_hits : kind == 1 ? &stats.row_empty : &stats.row_conflicts) += 1;
+    unsigned long long latency = end - chosen.arrival;
+    unsigned int bucket = 0;
+    while (bucket + 1 < DRAM_LATENCY_BUCKETS && latency >= 64ULL << bucket) {
+        bucket++;
+    }
+    stats.requests++;
+    stats.latency_sum += latency;
+    stats.latency_max = latency > stats.latency_max ? latency : stats.latency_max;
+    stats.latency[bucket]++;
+}
+
+
+/* void function, forget the requests in flight that completed by the current cycle
+ * @params: none
+ * @return: none
+ */
+static void retire() {
+
+    for (unsigned int i = 0; i < numDone;) {
+        if (done[i] <= now) {
+            done[i] = done[--numDone];
+        } else {
+            i++;
+        }
+    }
+}
+
+
+/* void function, issue a request for a block at the current cycle: the requests that could have started by now
+ * are scheduled first, and the core stalls until a miss completes while the queue is full
+ * @params: unsigned long address: the address of the block
+ * @return: none
+ */
+extern void dram_access(unsigned long address) {
+
+    if (!config.queue) {
+        return;
+    }
+
+    // the requests that could start by now were decided before this one arrived
+    for (;;) {
+        unsigned int ready = 0;
+        for (unsigned int i = 0; i < numWaiting && !ready; i++) {
+            ready = startOf(&waiting[i]) <= now;
+        }
+        if (!ready) {
+            break;
+        }
+        schedule();
+    }
+    retire();
+
+    // a full queue stalls the core until the first outstanding miss completes
+    while (numWaiting + numDone >= config.queue) {
+        while (numWaiting) {
+            schedule();
+        }
+        unsigned long long first = done[0];
+        for (unsigned int i = 1; i < numDone; i++) {
+            first = done[i] < first ? done[i] : first;
+        }
+        if (first > now) {
+            stats.stall_cycles += first - now;
+            now = first;
+        }
+        retire();
+    }
+
+    // channels interleave the blocks, then the columns of a row, the banks, the ranks and the rows
+    unsigned long block = address / BLOCK_BYTES;
+    request * next = &waiting[numWaiting++];
+    next->arrival = now;
+    next->channel = block % config.channels;
+    block /= config.channels;
+    block /= DRAM_ROW_BYTES / BLOCK_BYTES;
+    unsigned int bankIndex = block % config.banks;
+    block /= config.banks;
+    unsigned int rank = block % config.ranks;
+    next->row = block / config.ranks;
+    next->bankIndex = (next->channel * config.ranks + rank) * config.banks + bankIndex;
+}
+
+
+/* void function, advance the core
+ * @params: unsigned long cycles: the cycles
+ * @return: none
+ */
+extern void dram_tick(unsigned long cycles) {
+
+    now += cycles;
+}
+
+
+/* void function, schedule every waiting request and wait until all of them are done
+ * @params: none
+ * @return: none
+ */
+extern void dram_drain() {
+
+    while (numWaiting) {
+        schedule();
+    }
+    for (unsigned int i = 0; i < numDone; i++) {
+        if (done[i] > now) {
+            stats.stall_cycles += done[i] - now;
+            now = done[i];
+        }
+    }
+    numDone = 0;
+}
+
+
+/* void function, copy the statistics
+ * @params: struct dram_stats * dramStats: where the statistics are copied to
+ * @return: none
+ */
+extern void dram_get_stats(struct dram_stats *dramStats) {
+
+    *dramStats = stats;
+    dramStats->cycles = now - startCycle;
+}
+
+
+/* void function, set the statistics to 0
+ * @params: none
+ * @return: none
+ */
+extern void dram_reset_stats() {
+
+    memset(&stats, 0, sizeof(stats));
+    startCycle = now;
+}
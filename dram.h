@@ -0,0 +1,81 @@
+#ifndef CACHE_DRAM_H
+#define CACHE_DRAM_H
+
+/* A DRAM timing model behind memget().  Main memory is split into channels, each with ranks of banks, and
+ * every bank has a row buffer of DRAM_ROW_BYTES.  Blocks are interleaved over the channels first, then the
+ * columns of a row, the banks and the ranks, so consecutive blocks spread over the channels and then stay in
+ * one open row.  A block loaded from main memory is a request:
+ *   row hit:      the open row of the bank holds it, DRAM_T_CAS
+ *   row empty:    the bank has no open row, DRAM_T_RCD + DRAM_T_CAS
+ *   row conflict: another row is open and must be closed first, DRAM_T_RP + DRAM_T_RCD + DRAM_T_CAS
+ * then DRAM_T_BURST on the data bus of its channel.  With the open-page policy a row stays open after an
+ * access, with the closed-page policy every access closes it again (auto-precharge), so every request finds
+ * its bank empty.  The core issues one reference per cycle and keeps up to queue misses outstanding (MSHRs),
+ * it stalls while that many are.  The memory controller schedules the waiting requests FR-FCFS: of the
+ * requests that can start first, row hits before the others, then the oldest.  All times are core cycles.
+ */
+#define DRAM_PAGE_OPEN   0
+#define DRAM_PAGE_CLOSED 1
+
+#define DRAM_ROW_BYTES 8192
+#define DRAM_T_CAS     40
+#define DRAM_T_RCD     40
+#define DRAM_T_RP      40
+#define DRAM_T_BURST   10
+
+#define DRAM_MAX_QUEUE 64
+#define DRAM_LATENCY_BUCKETS 6  /* below 64, 128, 256, 512 and 1024 cycles, and the rest */
+
+/* The organization of the DRAM
+ *   channels, ranks, banks: the channels, the ranks per channel and the banks per rank
+ *   page:                   DRAM_PAGE_OPEN or DRAM_PAGE_CLOSED
+ *   queue:                  the misses the core keeps outstanding, 1 to DRAM_MAX_QUEUE
+ */
+struct dram_config {
+    unsigned int channels;
+    unsigned int ranks;
+    unsigned int banks;
+    unsigned int page;
+    unsigned int queue;
+};
+
+/* The statistics of the DRAM
+ *   requests:                        the blocks loaded
+ *   row_hits, row_empty, row_conflicts: the requests of each kind
+ *   latency_sum, latency_max:        the cycles from a request to the end of its data transfer, queueing included
+ *   latency[DRAM_LATENCY_BUCKETS]:   the requests per latency bucket
+ *   stall_cycles:                    the cycles the core waited for an outstanding miss
+ *   cycles:                          the cycles of the run, one per reference plus the stalls
+ */
+struct dram_stats {
+    unsigned long long requests;
+    unsigned long long row_hits;
+    unsigned long long row_empty;
+    unsigned long long row_conflicts;
+    unsigned long long latency_sum;
+    unsigned long long latency_max;
+    unsigned long long latency[DRAM_LATENCY_BUCKETS];
+    unsigned long long stall_cycles;
+    unsigned long long cycles;
+};
+
+/* Sets up an idle DRAM.  Returns 1 on success and 0 if the banks can't be allocated. */
+extern int dram_init(const struct dram_config *config);
+
+/* Issues a request for the block at address at the current cycle, after stalling the core if the
+ * queue is full.  Does nothing before dram_init().
+ */
+extern void dram_access(unsigned long address);
+
+/* Advances the core by the given cycles. */
+extern void dram_tick(unsigned long cycles);
+
+/* Schedules every waiting request and waits for all of them, so every request is counted. */
+extern void dram_drain(void);
+
+/* Copies the statistics. */
+extern void dram_get_stats(struct dram_stats *stats);
+
+/* Sets the statistics to 0, the state of the banks and the waiting requests are kept. */
+extern void dram_reset_stats(void);
+#endif //CACHE_DRAM_H
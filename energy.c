@@ -0,0 +1,35 @@
+/**
+ * @author hongh233
+ * @description: This C program will implement the energy and area model of a cache configuration: the dynamic
+ * energy of the tag and data arrays and of main memory from the counters of a run, and the leakage and the area
+ * of the fast memory from its size.
+ */
+
+#include "energy.h"
+
+
+/* void function, estimate the energy and the area of a run
+ * @params: const struct energy_params * params: the parameters of the model
+ * @params: const struct cache_stats * stats: the counters of the run
+ * @params: unsigned int tags: the tags an access compares
+ * @params: unsigned long long loads: the blocks loaded from DRAM
+ * @params: unsigned int F_size: the bytes of fast memory
+ * @params: unsigned long long cycles: the cycles of the run
+ * @params: struct energy_estimate * estimate: where the estimate is stored
+ * @return: none
+ */
+extern void energy_estimate(const struct energy_params *params, const struct cache_stats *stats, unsigned int tags,
+                            unsigned long long loads, unsigned int F_size, unsigned long long cycles,
+                            struct energy_estimate *estimate) {
+
+    double kilobytes = F_size / 1024.0;
+
+    // every access reads the tags it compares, a fill writes one more
+    estimate->tag = params->tag * ((double) stats->refs * tags + stats->fills);
+    estimate->data = params->data * ((double) stats->hits + stats->fills);
+    estimate->leakage = params->leakage * kilobytes * cycles;
+    estimate->dram = params->dram * loads;
+    estimate->total = estimate->tag + estimate->data + estimate->leakage + estimate->dram;
+    estimate->per_access = stats->refs ? estimate->total / stats->refs : 0;
+    estimate->area = params->area * kilobytes;
+}
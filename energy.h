@@ -0,0 +1,58 @@
+#ifndef CACHE_ENERGY_H
+#define CACHE_ENERGY_H
+
+#include "cache.h"
+
+/* An energy and area model of a cache configuration, driven by the counters of cache_get.  Every access reads
+ * the tags it compares (all the lines of a fully associative cache), a hit reads one block of data, a fill writes
+ * a tag and a block, and every block filled, or every DRAM request with --dram, is loaded from DRAM.  The fast
+ * memory leaks for every cycle of the run, in proportion to its size, which also sets the area.  Fast memory
+ * holds the tags and the metadata as well as the data, so a cache with more ways or sectors pays for them in
+ * leakage and area.  The default parameters are rough figures for an SRAM cache and
+ * DDR memory at about 32 nm and 1 GHz; sweeps should pass their own.
+ */
+#define ENERGY_TAG     1.5      /* pJ per tag read or written */
+#define ENERGY_DATA    12.0     /* pJ per 64-byte block read or written */
+#define ENERGY_LEAKAGE 0.02     /* pJ per KB of fast memory per cycle */
+#define ENERGY_DRAM    10000.0  /* pJ per block loaded from main memory */
+#define ENERGY_AREA    0.012    /* mm2 per KB of fast memory */
+
+/* The parameters of the model
+ *   tag, data, leakage, dram, area: see ENERGY_TAG, ENERGY_DATA, ENERGY_LEAKAGE, ENERGY_DRAM and ENERGY_AREA
+ */
+struct energy_params {
+    double tag;
+    double data;
+    double leakage;
+    double dram;
+    double area;
+};
+
+/* The estimate of a run, energies in pJ
+ *   tag, data, leakage, dram: the energy of each part
+ *   total, per_access:        their sum, and the sum per access
+ *   area:                     the area of the fast memory in mm2
+ */
+struct energy_estimate {
+    double tag;
+    double data;
+    double leakage;
+    double dram;
+    double total;
+    double per_access;
+    double area;
+};
+
+/* Estimates the energy and the area of a run.
+ *   params: the parameters of the model
+ *   stats:  the counters of the run
+ *   tags:   the tags an access compares, see cache_probed_tags()
+ *   loads:  the blocks loaded from DRAM
+ *   F_size: the bytes of fast memory
+ *   cycles: the cycles of the run
+ *   estimate: where the estimate is stored
+ */
+extern void energy_estimate(const struct energy_params *params, const struct cache_stats *stats, unsigned int tags,
+                            unsigned long long loads, unsigned int F_size, unsigned long long cycles,
+                            struct energy_estimate *estimate);
+#endif //CACHE_ENERGY_H
@@ -2,26 +2,1499 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+#include <limits.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
 #include "cache.h"
+#include "checkpoint.h"
+#include "simpoint.h"
+#include "report.h"
+#include "objcache.h"
+#include "values.h"
+#include "dram.h"
+#include "energy.h"
 
 struct cache_info c_info;
 static void *memory;
-static int hits;
-static int misses;
 static int miss;
 
+#define MAX_BRANCHES 16
+#define DEFAULT_QUANTUM 10000  /* the references per turn of a multi-programmed run */
+#define MISS_CYCLES 100        /* the cycles a miss takes in a --time-slice schedule, a hit takes 1 */
+
+/* What happens to the cache when a multi-programmed run switches programs */
+#define SWITCH_NONE  0  /* nothing, the programs share the address space and the blocks */
+#define SWITCH_FLUSH 1  /* every line is invalidated */
+#define SWITCH_ASID  2  /* the blocks are tagged with the program, so the programs never share them */
+
+static const char *policy_names[] = {"lru", "fifo", "random", "hawkeye"};
+static const char *object_policy_names[] = {"lru", "s3fifo", "lfu"};
+static const char *switch_names[] = {"none", "flush", "asid"};
+static const char *insertion_names[] = {"mru", "lip", "bip", "dip"};
+static const char *index_names[] = {"modulo", "xor", "prime", "skew", "zcache"};
+static const char *compression_names[] = {"none", "bdi", "fpc", "best"};
+static const char *page_names[] = {"open", "closed"};
+static const char *fill_names[] = {"random", "mixed"};
+
+/* How main memory is filled */
+#define FILL_RANDOM 0  /* random 31-bit words, which hardly compress and never repeat */
+#define FILL_MIXED  1  /* blocks of zeros, narrow, repeated, base-delta and patterned values, duplicates and random words */
+
+static const char *policy_name;         /* the --policy argument, parsed once the mode is known */
+static int objects;                      /* simulate an object cache instead of the block cache */
+static int object_policy;                /* the replacement policy of the object cache */
+static int admission;                    /* put a TinyLFU admission filter in front of eviction */
+static int object_ttl;                   /* the object trace records are time key size ttl */
+static int way_masks;                    /* 1 if --way-mask limited the ways of some tenant */
+static const char *program_files[CACHE_MAX_TENANTS]; /* the traces of a multi-programmed run */
+static int num_programs;                 /* number of programs, 0 to simulate the trace on stdin */
+static unsigned long quantum;            /* switch programs every quantum references */
+static unsigned long time_slice;         /* switch programs every time_slice cycles, 0 to use the quantum */
+static int switch_mode;                  /* what a switch does to the cache, see SWITCH_NONE */
+static unsigned long checkpoint_at;      /* save a checkpoint after this many references */
+static char *checkpoint_file;            /* the checkpoint to save, NULL to not save one */
+static char *restore_file;               /* the checkpoint to resume from, NULL to start cold */
+static unsigned long fork_at;            /* fork the branches after this many references */
+static unsigned int branches[MAX_BRANCHES]; /* the replacement policy of each branch */
+static int branch_admission[MAX_BRANCHES]; /* 1 if the branch filters fills with TinyLFU */
+static int num_branches;                 /* number of branches, 0 to not fork */
+static unsigned long warmup_refs;        /* don't count the first warmup_refs references */
+static int warmup_full;                  /* don't count references until the cache is full */
+static int warming;                      /* 1 while in the warmup window */
+static unsigned long interval;           /* print counters every interval counted references, 0 for never */
+static int verbose;                      /* print the detailed statistics after the hit rate */
+static char *stats_file;                 /* write machine-readable statistics here, NULL for none */
+static int stats_format = REPORT_JSON;   /* the format of the machine-readable statistics */
+static struct report_config report_config;
+static char warmup_text[24] = "0";       /* the warmup window as echoed in the statistics */
+static double progress_every;            /* print a progress line every progress_every seconds, 0 for never */
+static double progress_time;             /* when the last progress line was printed */
+static volatile sig_atomic_t dump_requested; /* set by SIGUSR1, the main loop prints a snapshot */
+
+static unsigned long simpoint_length;    /* simulate only representative intervals of this length, 0 for all */
+static unsigned long simpoint_k;         /* the number of representative intervals to pick */
+static unsigned long sample_period;      /* sample one unit every sample_period references, 0 for never */
+static unsigned long sample_unit;        /* number of references simulated in detail per unit */
+static struct dram_config dram;          /* the DRAM behind main memory, dram.queue is 0 for none */
+static int page_set;                     /* 1 if --page chose the row-buffer policy */
+static int memory_fill = FILL_RANDOM;    /* how main memory is filled, see FILL_RANDOM */
+static int energy;                       /* print the energy and area estimate with the stats */
+static struct energy_params energy_params = {ENERGY_TAG, ENERGY_DATA, ENERGY_LEAKAGE, ENERGY_DRAM, ENERGY_AREA};
+
+/* the state of a sampled run: the counters at the start of the current unit, the sum and
+ * sum of squares of the unit hit rates, and the time spent simulating in detail and warming
+ */
+static struct cache_stats unit_start;
+static int num_units;
+static double unit_rate_sum;
+static double unit_rate_sumsq;
+static double detailed_time;
+static double warming_time;
+static unsigned long detailed_refs;
+static unsigned long warming_refs;
+static int in_detail;
+
+/* the counters at the start of the current interval */
+static int interval_num;
+static struct cache_stats interval_start;
+static double interval_time;
+
+/* one program of a multi-programmed run, its trace is read lazily */
+struct program {
+    FILE *trace;             /* the trace, NULL once the program is done */
+    unsigned long num_refs;  /* the references of the trace */
+    unsigned long done;      /* the references simulated so far */
+};
+
+/* the counters a branch reports back to the parent */
+struct branch_result {
+    int ok;
+    double seconds;
+    struct cache_stats stats;
+    unsigned long long admitted;
+    unsigned long long rejected;
+};
+
+static void usage(const char *name) {
+    printf("Usage: %s [options] < trace\n", name);
+    printf("  --policy NAME        replacement policy: lru (default), fifo, random or hawkeye, with --objects lru, s3fifo or lfu\n");
+    printf("  --ttl                with --objects, the records are time key size ttl and objects expire\n");
+    printf("  --insertion NAME     where LRU inserts missing blocks: mru (default), lip, bip or dip (set dueling)\n");
+    printf("  --admission NAME     admission filter in front of eviction: none (default) or tinylfu\n");
+    printf("  --ways W             make the cache set-associative with W lines per set (default fully associative)\n");
+    printf("  --index NAME         set index function with --ways: modulo (default), xor, prime, skew or zcache\n");
+    printf("  --sectors N          split each line into N sectors (1, 2, 4 or 8) loaded on demand, and count the bytes\n");
+    printf("  --compress NAME      store the blocks compressed with --ways: none (default), bdi, fpc or best\n");
+    printf("  --dedup              share the data of identical blocks with --ways, counting the hashing per fill\n");
+    printf("  --values N           classify the filled and hit blocks by zero, narrow and repeated values in N regions\n");
+    printf("  --dram C:R:B[:Q]     time main memory as C channels of R ranks of B banks, Q misses outstanding (default 8)\n");
+    printf("  --page POLICY        row-buffer policy with --dram: open (default) or closed\n");
+    printf("  --energy             estimate the energy of the tag and data arrays, the leakage and DRAM, and the area\n");
+    printf("  --energy-params T:D:L:R:A  pJ per tag, per block of data, per KB and cycle leaked, per DRAM block, and mm2 per KB\n");
+    printf("  --memory FILL        fill main memory with random words (default) or a mixed set of compressible blocks\n");
+    printf("  --tenants N          the trace records are tenant address, with per-tenant statistics (up to %d)\n",
+           CACHE_MAX_TENANTS);
+    printf("  --way-mask T:MASK    let tenant T only fill the ways in the hex MASK (repeatable, needs --ways)\n");
+    printf("  --ucp N              repartition the ways between the tenants by utility every N references\n");
+    printf("  --program FILE       interleave the trace in FILE with the other programs (repeatable, up to %d)\n",
+           CACHE_MAX_TENANTS);
+    printf("  --quantum N          switch programs every N references (default %d)\n", DEFAULT_QUANTUM);
+    printf("  --time-slice C       switch programs every C cycles, a hit takes 1 cycle and a miss %d\n", MISS_CYCLES);
+    printf("  --switch MODE        on a switch: none (default, shared blocks), flush the cache or asid tags\n");
+    printf("  --objects            simulate an object cache: the trace holds key size records and F_size is in bytes\n");
+    printf("  --checkpoint N:FILE  save the cache to FILE after N references\n");
+    printf("  --restore FILE       resume from the checkpoint in FILE, skipping the references before it\n");
+    printf("  --warmup N|full      don't count the first N references, or the references until the cache is full\n");
+    printf("  --interval N         print hits, misses and evictions for every N counted references\n");
+    printf("  --sample P:U         simulate U of every P references in detail and only warm the cache with the rest\n");
+    printf("  --simpoint L:K       simulate only K representative intervals of L references and extrapolate\n");
+    printf("  --stats-file FILE    write the statistics to FILE (- for stdout) per interval and at the end\n");
+    printf("  --stats-format FMT   format of the --stats-file: json (one object per line, default) or csv\n");
+    printf("  --progress SECONDS   print references done, references per second and ETA to stderr periodically\n");
+    printf("  --verbose            print the fractional hit rate and per-1000-reference rates with the stats\n");
+    printf("  --fork-at N          warm the cache with N references, then run each branch on the rest\n");
+    printf("  --branch NAME        add a branch with replacement policy NAME, NAME+tinylfu to add admission (up to %d)\n",
+           MAX_BRANCHES);
+}
+
+static int parse_policy(const char *name, unsigned int *policy) {
+    for (unsigned int i = 0; i < sizeof(policy_names) / sizeof(policy_names[0]); i++) {
+        if (!strcmp(name, policy_names[i])) {
+            *policy = i;
+            return 1;
+        }
+    }
+    printf("Error: unknown policy %s\n", name);
+    return 0;
+}
+
+static int parse_options(int argc, char *argv[]) {
+    static struct option options[] = {
+        {"checkpoint", required_argument, 0, 'c'},
+        {"restore", required_argument, 0, 'r'},
+        {"policy", required_argument, 0, 'p'},
+        {"fork-at", required_argument, 0, 'f'},
+        {"branch", required_argument, 0, 'b'},
+        {"warmup", required_argument, 0, 'w'},
+        {"interval", required_argument, 0, 'i'},
+        {"sample", required_argument, 0, 's'},
+        {"simpoint", required_argument, 0, 'k'},
+        {"verbose", no_argument, 0, 'v'},
+        {"stats-file", required_argument, 0, 'o'},
+        {"stats-format", required_argument, 0, 'm'},
+        {"progress", required_argument, 0, 'g'},
+        {"objects", no_argument, 0, 'j'},
+        {"admission", required_argument, 0, 'a'},
+        {"ttl", no_argument, 0, 'l'},
+        {"ways", required_argument, 0, 'y'},
+        {"tenants", required_argument, 0, 't'},
+        {"way-mask", required_argument, 0, 'x'},
+        {"ucp", required_argument, 0, 'u'},
+        {"program", required_argument, 0, 'e'},
+        {"insertion", required_argument, 0, 'd'},
+        {"quantum", required_argument, 0, 'q'},
+        {"time-slice", required_argument, 0, 'z'},
+        {"switch", required_argument, 0, 'n'},
+        {"index", required_argument, 0, 'I'},
+        {"sectors", required_argument, 0, 'S'},
+        {"compress", required_argument, 0, 'C'},
+        {"dedup", no_argument, 0, 'D'},
+        {"values", required_argument, 0, 'V'},
+        {"dram", required_argument, 0, 'M'},
+        {"page", required_argument, 0, 'P'},
+        {"energy", no_argument, 0, 'E'},
+        {"energy-params", required_argument, 0, 'A'},
+        {"memory", required_argument, 0, 'F'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "c:r:p:f:b:w:i:s:k:vo:m:g:ja:ly:t:x:u:e:q:z:n:d:I:S:C:DV:M:P:EA:F:", options, 0)) != -1) {
+        switch (opt) {
+        case 'c': {
+            char *sep = strchr(optarg, ':');
+            if (!sep || sep == optarg || !sep[1]) {
+                printf("Error: --checkpoint expects N:FILE\n");
+                return 0;
+            }
+            checkpoint_at = strtoul(optarg, 0, 10);
+            checkpoint_file = sep + 1;
+            break;
+        }
+        case 'r':
+            restore_file = optarg;
+            break;
+        case 'p':
+            policy_name = optarg;
+            break;
+        case 'j':
+            objects = 1;
+            break;
+        case 'l':
+            object_ttl = 1;
+            break;
+        case 'y':
+            c_info.ways = strtoul(optarg, 0, 10);
+            if (!c_info.ways || c_info.ways > 255) {
+                printf("Error: --ways expects 1 to 255 lines per set\n");
+                return 0;
+            }
+            break;
+        case 't':
+            c_info.tenants = strtoul(optarg, 0, 10);
+            if (!c_info.tenants || c_info.tenants > CACHE_MAX_TENANTS) {
+                printf("Error: --tenants expects 1 to %d tenants\n", CACHE_MAX_TENANTS);
+                return 0;
+            }
+            break;
+        case 'x': {
+            char *sep = strchr(optarg, ':');
+            unsigned long tenant = strtoul(optarg, 0, 10);
+            unsigned long mask = sep ? strtoul(sep + 1, 0, 16) : 0;
+            if (!mask || tenant >= CACHE_MAX_TENANTS || mask > 0xffffffffUL) {
+                printf("Error: --way-mask expects T:MASK with a non-zero hex MASK\n");
+                return 0;
+            }
+            c_info.way_mask[tenant] = mask;
+            way_masks = 1;
+            break;
+        }
+        case 'u':
+            c_info.ucp_interval = strtoul(optarg, 0, 10);
+            if (!c_info.ucp_interval) {
+                printf("Error: --ucp expects a number of references\n");
+                return 0;
+            }
+            break;
+        case 'd':
+            for (c_info.insertion = 0; strcmp(optarg, insertion_names[c_info.insertion]);) {
+                if (++c_info.insertion == sizeof(insertion_names) / sizeof(insertion_names[0])) {
+                    printf("Error: unknown insertion policy %s\n", optarg);
+                    return 0;
+                }
+            }
+            break;
+        case 'I':
+            for (c_info.index = 0; strcmp(optarg, index_names[c_info.index]);) {
+                if (++c_info.index == sizeof(index_names) / sizeof(index_names[0])) {
+                    printf("Error: unknown set index function %s\n", optarg);
+                    return 0;
+                }
+            }
+            break;
+        case 'S':
+            c_info.sectors = strtoul(optarg, 0, 10);
+            if (!c_info.sectors || c_info.sectors > 8 || (c_info.sectors & (c_info.sectors - 1))) {
+                printf("Error: --sectors expects 1, 2, 4 or 8 sectors per line\n");
+                return 0;
+            }
+            break;
+        case 'C':
+            for (c_info.compression = 0; strcmp(optarg, compression_names[c_info.compression]);) {
+                if (++c_info.compression == sizeof(compression_names) / sizeof(compression_names[0])) {
+                    printf("Error: unknown compression %s\n", optarg);
+                    return 0;
+                }
+            }
+            break;
+        case 'D':
+            c_info.dedup = 1;
+            break;
+        case 'V':
+            c_info.values = strtoul(optarg, 0, 10);
+            if (!c_info.values || c_info.values > VALUES_MAX_REGIONS) {
+                printf("Error: --values expects 1 to %d regions\n", VALUES_MAX_REGIONS);
+                return 0;
+            }
+            break;
+        case 'M': {
+            char *end;
+            unsigned int *fields[] = {&dram.channels, &dram.ranks, &dram.banks, &dram.queue};
+            unsigned int num_fields = 0;
+            for (char *field = optarg; num_fields < 4; field = end + 1) {
+                *fields[num_fields++] = strtoul(field, &end, 10);
+                if (*end != ':') {
+                    break;
+                }
+            }
+            dram.queue = num_fields == 4 ? dram.queue : 8;
+            if (num_fields < 3 || *end || !dram.channels || !dram.ranks || !dram.banks || !dram.queue ||
+                dram.queue > DRAM_MAX_QUEUE) {
+                printf("Error: --dram expects C:R:B[:Q] with C, R and B positive and 0 < Q <= %d\n", DRAM_MAX_QUEUE);
+                return 0;
+            }
+            break;
+        }
+        case 'P':
+            for (dram.page = 0; strcmp(optarg, page_names[dram.page]);) {
+                if (++dram.page == sizeof(page_names) / sizeof(page_names[0])) {
+                    printf("Error: unknown page policy %s\n", optarg);
+                    return 0;
+                }
+            }
+            page_set = 1;
+            break;
+        case 'E':
+            energy = 1;
+            break;
+        case 'F':
+            for (memory_fill = 0; strcmp(optarg, fill_names[memory_fill]);) {
+                if (++memory_fill == sizeof(fill_names) / sizeof(fill_names[0])) {
+                    printf("Error: unknown memory fill %s\n", optarg);
+                    return 0;
+                }
+            }
+            break;
+        case 'A': {
+            char *end = optarg;
+            double *fields[] = {&energy_params.tag, &energy_params.data, &energy_params.leakage, &energy_params.dram,
+                                &energy_params.area};
+            for (unsigned int f = 0; f < 5; f++) {
+                char *field = end + (f > 0);
+                *fields[f] = strtod(field, &end);
+                if (end == field || *fields[f] < 0 || *end != (f < 4 ? ':' : '\0')) {
+                    printf("Error: --energy-params expects T:D:L:R:A, five numbers of at least 0\n");
+                    return 0;
+                }
+            }
+            energy = 1;
+            break;
+        }
+        case 'e':
+            if (num_programs == CACHE_MAX_TENANTS) {
+                printf("Error: at most %d programs\n", CACHE_MAX_TENANTS);
+                return 0;
+            }
+            program_files[num_programs++] = optarg;
+            break;
+        case 'q':
+        case 'z':
+            *(opt == 'q' ? &quantum : &time_slice) = strtoul(optarg, 0, 10);
+            if (!(opt == 'q' ? quantum : time_slice)) {
+                printf("Error: --%s expects a positive number\n", opt == 'q' ? "quantum" : "time-slice");
+                return 0;
+            }
+            break;
+        case 'n':
+            for (switch_mode = 0; strcmp(optarg, switch_names[switch_mode]);) {
+                if (++switch_mode == sizeof(switch_names) / sizeof(switch_names[0])) {
+                    printf("Error: unknown switch mode %s\n", optarg);
+                    return 0;
+                }
+            }
+            break;
+        case 'f':
+            fork_at = strtoul(optarg, 0, 10);
+            break;
+        case 'b': {
+            if (num_branches == MAX_BRANCHES) {
+                printf("Error: at most %d branches\n", MAX_BRANCHES);
+                return 0;
+            }
+            char name[32];
+            snprintf(name, sizeof(name), "%s", optarg);
+            char *suffix = strstr(name, "+tinylfu");
+            if (suffix && !suffix[8]) {
+                *suffix = 0;
+                branch_admission[num_branches] = 1;
+            }
+            if (!parse_policy(name, &branches[num_branches++])) {
+                return 0;
+            }
+            break;
+        }
+        case 'a':
+            if (!strcmp(optarg, "tinylfu")) {
+                admission = 1;
+            } else if (strcmp(optarg, "none")) {
+                printf("Error: unknown admission filter %s\n", optarg);
+                return 0;
+            }
+            break;
+        case 'w':
+            if (!strcmp(optarg, "full")) {
+                warmup_full = 1;
+                snprintf(warmup_text, sizeof(warmup_text), "full");
+            } else {
+                char *end;
+                warmup_refs = strtoul(optarg, &end, 10);
+                if (end == optarg || *end || *optarg == '-') {
+                    printf("Error: --warmup expects N or full\n");
+                    return 0;
+                }
+                snprintf(warmup_text, sizeof(warmup_text), "%lu", warmup_refs);
+            }
+            warming = warmup_full || warmup_refs;
+            break;
+        case 'i':
+            interval = strtoul(optarg, 0, 10);
+            break;
+        case 's': {
+            char *sep = strchr(optarg, ':');
+            sample_period = strtoul(optarg, 0, 10);
+            sample_unit = sep ? strtoul(sep + 1, 0, 10) : 0;
+            if (!sample_unit || sample_unit > sample_period) {
+                printf("Error: --sample expects P:U with 0 < U <= P\n");
+                return 0;
+            }
+            break;
+        }
+        case 'v':
+            verbose = 1;
+            break;
+        case 'o':
+            stats_file = optarg;
+            break;
+        case 'g':
+            progress_every = atof(optarg);
+            break;
+        case 'm':
+            if (!strcmp(optarg, "json")) {
+                stats_format = REPORT_JSON;
+            } else if (!strcmp(optarg, "csv")) {
+                stats_format = REPORT_CSV;
+            } else {
+                printf("Error: unknown stats format %s\n", optarg);
+                return 0;
+            }
+            break;
+        case 'k': {
+            char *sep = strchr(optarg, ':');
+            simpoint_length = strtoul(optarg, 0, 10);
+            simpoint_k = sep ? strtoul(sep + 1, 0, 10) : 0;
+            if (!simpoint_length || !simpoint_k || simpoint_k > SIMPOINT_MAX_K) {
+                printf("Error: --simpoint expects L:K with L > 0 and 0 < K <= %d\n", SIMPOINT_MAX_K);
+                return 0;
+            }
+            break;
+        }
+        default:
+            usage(argv[0]);
+            return 0;
+        }
+    }
+    // every program of a multi-programmed run is a tenant of the cache
+    if (num_programs) {
+        if (objects || num_branches || sample_period || simpoint_length || checkpoint_file || restore_file ||
+            warming || interval) {
+            printf("Error: --program can't be combined with --objects, --fork-at, --sample, --simpoint, "
+                   "--checkpoint, --restore, --warmup or --interval\n");
+            return 0;
+        }
+        if (c_info.tenants && c_info.tenants != num_programs) {
+            printf("Error: --tenants must match the number of programs\n");
+            return 0;
+        }
+        if (quantum && time_slice) {
+            printf("Error: --quantum and --time-slice can't be combined\n");
+            return 0;
+        }
+        c_info.tenants = num_programs;
+        c_info.asid = switch_mode == SWITCH_ASID;
+        quantum = quantum ? quantum : DEFAULT_QUANTUM;
+    } else if (quantum || time_slice || switch_mode) {
+        printf("Error: --quantum, --time-slice and --switch need --program\n");
+        return 0;
+    }
+
+    if (objects) {
+        for (object_policy = 0; policy_name && strcmp(policy_name, object_policy_names[object_policy]);) {
+            if (++object_policy == sizeof(object_policy_names) / sizeof(object_policy_names[0])) {
+                printf("Error: unknown object cache policy %s\n", policy_name);
+                return 0;
+            }
+        }
+        if (num_branches || sample_period || simpoint_length || checkpoint_file || restore_file || warming ||
+            interval || c_info.ways || c_info.tenants || c_info.insertion || c_info.sectors ||
+            c_info.compression || c_info.dedup || c_info.values || dram.queue || energy || memory_fill) {
+            printf("Error: --objects can't be combined with block cache options\n");
+            return 0;
+        }
+    } else if (policy_name && !parse_policy(policy_name, &c_info.policy)) {
+        return 0;
+    }
+
+    // a branch with admission needs the filter trained during the shared prefix
+    c_info.admission = admission ? CACHE_ADMISSION_TINYLFU : CACHE_ADMISSION_NONE;
+    for (int b = 0; b < num_branches; b++) {
+        if (branch_admission[b] && !admission) {
+            c_info.admission = CACHE_ADMISSION_TRAIN;
+        }
+        if (branches[b] == CACHE_POLICY_HAWKEYE && c_info.policy != CACHE_POLICY_HAWKEYE) {
+            printf("Error: a hawkeye branch needs --policy hawkeye, which sets up its predictor\n");
+            return 0;
+        }
+    }
+    if (object_ttl && !objects) {
+        printf("Error: --ttl needs --objects\n");
+        return 0;
+    }
+    if (c_info.insertion && c_info.policy != CACHE_POLICY_LRU) {
+        printf("Error: --insertion needs --policy lru\n");
+        return 0;
+    }
+    if (c_info.index && !c_info.ways) {
+        printf("Error: --index needs --ways\n");
+        return 0;
+    }
+    if (c_info.index >= CACHE_INDEX_SKEW && (c_info.insertion || c_info.ucp_interval ||
+                                             c_info.policy == CACHE_POLICY_HAWKEYE)) {
+        printf("Error: --index %s has no sets to rank, so it can't be combined with --insertion, --ucp or hawkeye\n",
+               index_names[c_info.index]);
+        return 0;
+    }
+    if (c_info.index == CACHE_INDEX_ZCACHE && way_masks) {
+        printf("Error: --index zcache relocates blocks across ways, so it can't be combined with --way-mask\n");
+        return 0;
+    }
+    if ((c_info.compression || c_info.dedup) && !c_info.ways) {
+        printf("Error: --compress and --dedup need --ways\n");
+        return 0;
+    }
+    if (c_info.compression && c_info.dedup) {
+        printf("Error: --compress and --dedup can't be combined\n");
+        return 0;
+    }
+    if ((c_info.compression || c_info.dedup) && (c_info.index >= CACHE_INDEX_SKEW || c_info.sectors || c_info.insertion ||
+                               c_info.tenants || c_info.admission || c_info.policy == CACHE_POLICY_HAWKEYE)) {
+        printf("Error: --compress and --dedup can't be combined with --index skew or zcache, --sectors, --insertion, --tenants, "
+               "--program, --admission, a +tinylfu branch or hawkeye\n");
+        return 0;
+    }
+    if (c_info.values && (c_info.sectors || num_branches || num_programs)) {
+        printf("Error: --values can't be combined with --sectors, --fork-at or --program\n");
+        return 0;
+    }
+    if (page_set && !dram.queue) {
+        printf("Error: --page needs --dram\n");
+        return 0;
+    }
+    if (dram.queue && (num_branches || num_programs || sample_period || simpoint_length)) {
+        printf("Error: --dram can't be combined with --fork-at, --program, --sample or --simpoint\n");
+        return 0;
+    }
+    if ((way_masks || c_info.ucp_interval) && !c_info.tenants) {
+        printf("Error: --way-mask and --ucp need --tenants\n");
+        return 0;
+    }
+    if ((way_masks || c_info.ucp_interval) && (!c_info.ways || c_info.ways > CACHE_MAX_WAYS)) {
+        printf("Error: --way-mask and --ucp need --ways of at most %d\n", CACHE_MAX_WAYS);
+        return 0;
+    }
+    for (unsigned int t = 0; t < CACHE_MAX_TENANTS; t++) {
+        if (c_info.way_mask[t] && (t >= c_info.tenants || c_info.way_mask[t] >> (c_info.ways - 1) > 1)) {
+            printf("Error: --way-mask %u:%x is outside of the tenants or the ways\n", t, c_info.way_mask[t]);
+            return 0;
+        }
+    }
+    if (c_info.ucp_interval && c_info.tenants > c_info.ways) {
+        printf("Error: --ucp needs at least one way per tenant\n");
+        return 0;
+    }
+    if (c_info.tenants && (num_branches || simpoint_length)) {
+        printf("Error: --tenants can't be combined with --fork-at or --simpoint\n");
+        return 0;
+    }
+    if (fork_at && !num_branches) {
+        printf("Error: --fork-at needs at least one --branch\n");
+        return 0;
+    }
+    if ((num_branches != 0) + (sample_period != 0) + (simpoint_length != 0) > 1) {
+        printf("Error: --fork-at, --sample and --simpoint can't be combined\n");
+        return 0;
+    }
+    if (simpoint_length && warming) {
+        printf("Error: --simpoint warms each interval itself, so it can't be combined with --warmup\n");
+        return 0;
+    }
+    return 1;
+}
+
+/* Returns a monotonic time stamp in seconds. */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
 static void log_result(unsigned long address) {
-    hits += !miss;
-    misses += miss != 0;
 #ifdef DEBUG
     static char * result[] = {"miss", "hit"};
     printf("Cache %s @ 0x%8.8lx\n", result[!miss], address);
 #endif
 }
 
-int main() {
+/* Prints one line of the value-locality analysis: the blocks, and the shares of the blocks and of the words
+ * that are zero, narrow and repeated.
+ */
+static void print_values(const char *label, const struct value_stats *stats) {
+    double blocks = stats->blocks ? 100.0 / stats->blocks : 0;
+    double words = stats->blocks ? 100.0 / (16 * stats->blocks) : 0;
+    printf("%s: %llu blocks, zero: %.2f%%, narrow: %.2f%%, repeated: %.2f%% -- words zero: %.2f%%, narrow: %.2f%%, "
+           "repeated: %.2f%%\n", label, stats->blocks, blocks * stats->zero, blocks * stats->narrow,
+           blocks * stats->repeated, words * stats->zero_words, words * stats->narrow_words,
+           words * stats->repeated_words);
+}
+
+/* Adds up the value-locality analysis of the fills and of the hits of every region. */
+static void sum_values(struct value_stats *fills, struct value_stats *hits) {
+    memset(fills, 0, sizeof(*fills));
+    memset(hits, 0, sizeof(*hits));
+    for (unsigned int r = 0; r < c_info.values; r++) {
+        struct value_stats region[2];
+        values_get(r, &region[0], &region[1]);
+        for (int k = 0; k < 2; k++) {
+            struct value_stats *total = k ? hits : fills;
+            total->blocks += region[k].blocks;
+            total->zero += region[k].zero;
+            total->narrow += region[k].narrow;
+            total->repeated += region[k].repeated;
+            total->zero_words += region[k].zero_words;
+            total->narrow_words += region[k].narrow_words;
+            total->repeated_words += region[k].repeated_words;
+        }
+    }
+}
+
+/* Prints the value-locality analysis of the fills and the hits of the whole main memory, then of each
+ * region that had any.
+ */
+static void report_values(void) {
+    struct value_stats fills, hits;
+    sum_values(&fills, &hits);
+    print_values("Values fills", &fills);
+    print_values("Values hits", &hits);
+    for (unsigned int r = 0; r < c_info.values && c_info.values > 1; r++) {
+        struct value_stats region[2];
+        unsigned long start = values_get(r, &region[0], &region[1]);
+        char label[64];
+        for (int k = 0; k < 2; k++) {
+            if (region[k].blocks) {
+                snprintf(label, sizeof(label), "Values region %u at 0x%lx %s", r, start, k ? "hits" : "fills");
+                print_values(label, &region[k]);
+            }
+        }
+    }
+}
+
+/* Prints the DRAM statistics once every outstanding miss completed: the requests by row-buffer state,
+ * their latency and the cycles the core stalled, and the requests per latency bucket.
+ */
+static void report_dram(void) {
+    struct dram_stats stats;
+    dram_drain();
+    dram_get_stats(&stats);
+    double share = stats.requests ? 100.0 / stats.requests : 0;
+    printf("DRAM: %u channels, %u ranks, %u banks, %s page, %u outstanding -- requests: %llu, row hits: %.2f%%, "
+           "empty: %.2f%%, conflicts: %.2f%%, latency mean: %.1f max: %llu cycles, cycles: %llu, stall cycles: %llu\n",
+           dram.channels, dram.ranks, dram.banks, page_names[dram.page], dram.queue, stats.requests,
+           share * stats.row_hits, share * stats.row_empty, share * stats.row_conflicts,
+           stats.requests ? (double) stats.latency_sum / stats.requests : 0, stats.latency_max, stats.cycles,
+           stats.stall_cycles);
+    printf("DRAM latency:");
+    for (unsigned int b = 0; b + 1 < DRAM_LATENCY_BUCKETS; b++) {
+        printf(" <%u: %.2f%%,", 64 << b, share * stats.latency[b]);
+    }
+    printf(" >=%u: %.2f%%\n", 64 << (DRAM_LATENCY_BUCKETS - 2), share * stats.latency[DRAM_LATENCY_BUCKETS - 1]);
+}
+
+/* Estimates the energy and area of the counted references.  The run takes the cycles of the DRAM
+ * model with --dram and loads its requests, otherwise a cycle per hit and MISS_CYCLES per miss, and the
+ * blocks filled.  Returns the cycles of the run.
+ */
+static unsigned long long estimate_energy(const struct cache_stats *stats, struct energy_estimate *estimate) {
+    unsigned long long cycles = stats->hits + stats->misses * MISS_CYCLES;
+    unsigned long long loads = stats->fills;
+    if (dram.queue) {
+        struct dram_stats timing;
+        dram_get_stats(&timing);
+        cycles = timing.cycles;
+        loads = timing.requests;
+    }
+    energy_estimate(&energy_params, stats, cache_probed_tags(), loads, c_info.F_size, cycles, estimate);
+    return cycles;
+}
+
+/* Prints the energy and area estimate of the counted references. */
+static void report_energy(const struct cache_stats *stats) {
+    struct energy_estimate estimate;
+    unsigned long long cycles = estimate_energy(stats, &estimate);
+    printf("Energy: tag: %.3f nJ, data: %.3f nJ, leakage: %.3f nJ, DRAM: %.3f nJ, total: %.3f nJ, per access: %.2f pJ, "
+           "cycles: %llu, area: %.4f mm2\n", estimate.tag / 1000, estimate.data / 1000, estimate.leakage / 1000,
+           estimate.dram / 1000, estimate.total / 1000, estimate.per_access, cycles, estimate.area);
+}
+
+/* Prints the hit and miss line of the stats, and with --verbose the fractional hit rate and the
+ * misses, fills and evictions per 1000 references.  All the arithmetic is done in 64 bits or
+ * floating point, so it can't overflow.
+ */
+static void report_stats(const struct cache_stats *stats) {
+    printf("Cache hits: %llu, misses: %llu -- hit rate %llu%%\n", stats->hits, stats->misses,
+           stats->refs ? 100 * stats->hits / stats->refs : 0);
+    if (verbose) {
+        double per_1000 = stats->refs ? 1000.0 / stats->refs : 0;
+        printf("Cache refs: %llu, fills: %llu, evictions: %llu -- hit rate %.4f%%, per 1000 refs: "
+               "%.3f misses, %.3f fills, %.3f evictions\n", stats->refs, stats->fills, stats->evictions,
+               per_1000 * stats->hits / 10, per_1000 * stats->misses, per_1000 * stats->fills,
+               per_1000 * stats->evictions);
+    }
+    if (c_info.admission == CACHE_ADMISSION_TINYLFU) {
+        unsigned long long admitted, rejected;
+        cache_get_admission(&admitted, &rejected);
+        printf("Cache admission: admitted: %llu, rejected: %llu\n", admitted, rejected);
+    }
+    if (c_info.insertion == CACHE_INSERT_DIP) {
+        unsigned int psel = cache_get_psel();
+        printf("Cache insertion: dip, policy selector: %u of 1023 (%s)\n", psel, psel > 511 ? "bip" : "mru");
+    }
+    if (c_info.sectors) {
+        unsigned long long fetched, used;
+        cache_get_sectors(&fetched, &used);
+        printf("Cache sectors: %u of %u bytes, bytes fetched: %llu, used: %llu (%.2f%%)\n", c_info.sectors,
+               64 / c_info.sectors, fetched, used, fetched ? 100.0 * used / fetched : 0);
+    }
+    if (c_info.compression) {
+        unsigned long long fills, bytes;
+        unsigned int resident, lines;
+        cache_get_compression(&fills, &bytes, &resident, &lines);
+        printf("Cache compression: %s, blocks compressed: %llu, mean size: %.2f bytes, resident blocks: %u in %u lines "
+               "(%.3fx capacity)\n", compression_names[c_info.compression], fills, fills ? (double) bytes / fills : 0,
+               resident, lines, lines ? (double) resident / lines : 0);
+    }
+    if (c_info.dedup) {
+        struct cache_dedup_stats dedup;
+        cache_get_dedup(&dedup);
+        printf("Cache dedup: fills: %llu, deduplicated: %llu, resident blocks: %u in %u lines (%.3fx capacity), "
+               "distinct: %u, per fill: %.3f probes, %.3f compares\n", dedup.fills, dedup.deduplicated, dedup.resident,
+               dedup.lines, dedup.lines ? (double) dedup.resident / dedup.lines : 0, dedup.distinct,
+               dedup.fills ? (double) dedup.probes / dedup.fills : 0,
+               dedup.fills ? (double) dedup.compares / dedup.fills : 0);
+    }
+    if (c_info.index == CACHE_INDEX_ZCACHE) {
+        unsigned long long relocations, candidates;
+        cache_get_relocations(&relocations, &candidates);
+        printf("Cache relocations: %llu, per fill: %.3f relocations, %.2f candidates\n", relocations,
+               stats->fills ? (double) relocations / stats->fills : 0, stats->fills ? (double) candidates / stats->fills : 0);
+    }
+    if (c_info.values) {
+        report_values();
+    }
+    if (dram.queue) {
+        report_dram();
+    }
+    if (energy) {
+        report_energy(stats);
+    }
+    for (unsigned int t = 0; t < c_info.tenants; t++) {
+        struct cache_tenant_stats tenant;
+        cache_get_tenant_stats(t, &tenant);
+        printf("Tenant %u: hits: %llu, misses: %llu -- hit rate %llu%%, occupancy: %u lines, evicted by others: %llu, "
+               "way mask: 0x%x\n", t, tenant.stats.hits, tenant.stats.misses,
+               tenant.stats.refs ? 100 * tenant.stats.hits / tenant.stats.refs : 0, tenant.occupancy,
+               tenant.evicted_by_others, tenant.way_mask);
+    }
+}
+
+/* Writes the summary record of the --stats-file, if any, with the results of the DRAM, value-locality
+ * and energy models the block cache runs with, then closes it.
+ */
+static void close_stats(const struct cache_stats *stats, unsigned long trace_refs, double seconds) {
+    struct report_results results = {0};
+    struct dram_stats timing;
+    struct value_stats fills, hits;
+    struct energy_estimate estimate;
+    if (stats_file && dram.queue) {
+        dram_drain();
+        dram_get_stats(&timing);
+        results.dram = &timing;
+    }
+    if (stats_file && c_info.values) {
+        sum_values(&fills, &hits);
+        results.value_fills = &fills;
+        results.value_hits = &hits;
+    }
+    if (stats_file && energy) {
+        results.cycles = estimate_energy(stats, &estimate);
+        results.energy = &estimate;
+    }
+    report_close(stats, trace_refs, seconds, &results);
+}
+
+/* Prints the counters of the interval that just ended and starts the next one. */
+static void log_interval(void) {
+    struct cache_stats current, part;
+    cache_get_stats(&current);
+    cache_stats_diff(&part, &current, &interval_start);
+    double time = now();
+    if (part.refs) {
+        printf("Interval %d: hits: %llu, misses: %llu, evictions: %llu -- hit rate %llu%%\n", interval_num,
+               part.hits, part.misses, part.evictions, 100 * part.hits / part.refs);
+        report_interval(interval_num, &part, time - interval_time);
+    }
+    interval_num++;
+    interval_start = current;
+    interval_time = time;
+}
+
+/* Ends the warmup window once the reference about to be simulated is past it: the first
+ * warmup_refs references, or every reference until the cache is full.  The references
+ * simulated so far are dropped from the statistics.
+ */
+static void check_warmup(unsigned long ref) {
+    if (warming && (warmup_full ? cache_full() : ref >= warmup_refs)) {
+        warming = 0;
+        cache_reset_stats();
+        dram_reset_stats();
+        cache_get_stats(&interval_start);
+        interval_time = now();
+    }
+}
+
+/* Records the hit rate of the sampling unit that just ended. */
+static void end_unit(void) {
+    struct cache_stats now, part;
+    cache_get_stats(&now);
+    cache_stats_diff(&part, &now, &unit_start);
+    if (part.refs) {
+        double rate = (double)part.hits / part.refs;
+        num_units++;
+        unit_rate_sum += rate;
+        unit_rate_sumsq += rate * rate;
+    }
+    unit_start = now;
+}
+
+/* Prints the sampled hit rate with its 95% confidence interval, and the speedup over simulating
+ * every reference in detail, estimated from the time a detailed reference takes.
+ */
+static void report_sampling(void) {
+    double mean = num_units ? unit_rate_sum / num_units : 0;
+    double variance = num_units > 1 ? (unit_rate_sumsq - num_units * mean * mean) / (num_units - 1) : 0;
+    double error = 1.96 * sqrt(variance > 0 ? variance / num_units : 0);
+    printf("Sampled hit rate %.2f%% +/- %.2f%% (95%% confidence, %d units of %lu references)\n",
+           100 * mean, 100 * error, num_units, sample_unit);
+
+    double full_time = detailed_refs ? detailed_time / detailed_refs * (detailed_refs + warming_refs) : 0;
+    double sampled_time = detailed_time + warming_time;
+    printf("Simulated %lu of %lu references in detail, speedup over full simulation %.2fx\n",
+           detailed_refs, detailed_refs + warming_refs, sampled_time > 0 ? full_time / sampled_time : 1.0);
+}
+
+/* Copies the counters of the simulated cache: the block cache, or the object cache with --objects,
+ * where every miss of an object that fits is a fill.
+ */
+static void current_stats(struct cache_stats *stats) {
+    if (!objects) {
+        cache_get_stats(stats);
+        return;
+    }
+    struct objcache_stats object;
+    objcache_get_stats(&object);
+    stats->refs = object.refs;
+    stats->hits = object.hits;
+    stats->misses = object.misses;
+    stats->fills = object.misses - object.too_large;
+    stats->evictions = object.evictions;
+}
+
+/* SIGUSR1 handler, only flags the request, the main loop prints the snapshot between
+ * references, so the hot loop never takes a lock and nothing unsafe runs in the handler.
+ */
+static void request_dump(int signum) {
+    (void)signum;
+    dump_requested = 1;
+}
+
+/* Called between references: prints a snapshot of the counters if SIGUSR1 arrived, and a progress
+ * line every progress_every seconds.  Both go to stderr, so they don't mix with the trace output.
+ */
+static void poll_status(unsigned long ref, unsigned long first_ref, unsigned long num_refs, double run_start) {
+    if (dump_requested) {
+        dump_requested = 0;
+        struct cache_stats stats;
+        current_stats(&stats);
+        fprintf(stderr, "Snapshot at reference %lu of %lu: refs: %llu, hits: %llu, misses: %llu, fills: %llu, "
+                        "evictions: %llu -- hit rate %.2f%%\n", ref, num_refs, stats.refs, stats.hits,
+                stats.misses, stats.fills, stats.evictions, stats.refs ? 100.0 * stats.hits / stats.refs : 0.0);
+    }
+
+    // reading the clock on every reference would cost more than the check saves
+    if (progress_every > 0 && (ref & 4095) == 0) {
+        double time = now();
+        if (time - progress_time >= progress_every) {
+            double speed = (ref - first_ref) / (time - run_start);
+            fprintf(stderr, "Progress: %lu of %lu references (%.1f%%), %.0f refs/s, ETA %.0fs\n", ref, num_refs,
+                    num_refs ? 100.0 * ref / num_refs : 100.0, speed, speed > 0 ? (num_refs - ref) / speed : 0.0);
+            progress_time = time;
+        }
+    }
+}
+
+/* Simulates one reference: loads the word through the cache, checks it against memory and
+ * counts the hit or miss.  Returns 1 on success and 0 if the cache returned a wrong value.
+ */
+static int simulate(unsigned int address, int print) {
+    assert(address <= c_info.M_size);
+
+    unsigned long word;
+    miss = 0;
+    dram_tick(1);
+    cache_get(address, &word);
+    unsigned long expected = *(unsigned long *)(memory + address);
+
+    if (word != expected) {
+        printf("Error reading memory address 0x%8.8x\n", address);
+        printf("  Expected 0x%16.16lx\n", expected);
+        printf("  Actual 0x%16.16lx\n", word);
+        return 0;
+    }
+
+    // references in the warmup window only warm the cache, they aren't counted
+    log_result(address);
+    if (!warming && interval) {
+        struct cache_stats now;
+        cache_get_stats(&now);
+        if (now.refs - interval_start.refs == interval) {
+            log_interval();
+        }
+    }
+
+    if (print) {
+        printf("Loaded value [0x%16.16lx] @ address 0x%8.8x\n", word, address);
+    }
+    return 1;
+}
+
+/* Reads the next count references of the trace into a new array.  Returns NULL on failure. */
+static unsigned int *read_refs(unsigned long count) {
+    unsigned int *refs = malloc((count + 1) * sizeof(unsigned int));
+    assert(refs);
+    for (unsigned long i = 0; i < count; i++) {
+        if (scanf("%u", &refs[i]) != 1) {
+            printf("Error reading operation\n");
+            free(refs);
+            return 0;
+        }
+    }
+    return refs;
+}
+
+/* Runs every branch on references first..num_refs-1 of the trace, starting from the current
+ * (warmed) cache.  Each branch is a forked child, so the cache and the memory are shared
+ * copy-on-write and the branches run concurrently.  The suffix of the trace is read before
+ * forking, since the children can't share stdin.  Prints one comparison report, and writes a
+ * --stats-file record per branch with the prefix, which took prefix_seconds, and the branch together.
+ */
+static int run_branches(unsigned long first, unsigned long num_refs, double prefix_seconds) {
+    unsigned long num_suffix = num_refs - first;
+    unsigned int *suffix = read_refs(num_suffix);
+    if (!suffix) {
+        return 0;
+    }
+
+    pid_t pids[MAX_BRANCHES];
+    int pipes[MAX_BRANCHES];
+    for (int b = 0; b < num_branches; b++) {
+        int fds[2];
+        int piped = pipe(fds) == 0;
+        if (!piped || (pids[b] = fork()) < 0) {
+            printf("Error forking branch %d\n", b);
+            if (piped) {
+                close(fds[0]);
+                close(fds[1]);
+            }
+            // the branches already forked fail to report once their pipe is closed
+            for (int earlier = 0; earlier < b; earlier++) {
+                close(pipes[earlier]);
+                waitpid(pids[earlier], 0, 0);
+            }
+            free(suffix);
+            return 0;
+        }
+
+        // the child runs the suffix with its own policy and reports its counters
+        if (pids[b] == 0) {
+            close(fds[0]);
+            struct branch_result result = {.ok = 1};
+            c_info.policy = branches[b];
+            if (branch_admission[b]) {
+                c_info.admission = CACHE_ADMISSION_TINYLFU;
+            } else if (c_info.admission != CACHE_ADMISSION_NONE) {
+                c_info.admission = CACHE_ADMISSION_TRAIN;
+            }
+            unsigned long long admitted, rejected;
+            cache_get_admission(&admitted, &rejected);
+            cache_reset_stats();
+            warming = interval = 0;
+            double start = now();
+            for (unsigned long i = 0; i < num_suffix && result.ok; i++) {
+                result.ok = simulate(suffix[i], 0);
+            }
+            result.seconds = now() - start;
+            cache_get_stats(&result.stats);
+            cache_get_admission(&result.admitted, &result.rejected);
+            result.admitted -= admitted;
+            result.rejected -= rejected;
+            _exit(write(fds[1], &result, sizeof(result)) != sizeof(result));
+        }
+        close(fds[1]);
+        pipes[b] = fds[0];
+    }
+
+    // each branch reports the counters of the suffix, the whole run adds the shared prefix
+    struct cache_stats prefix;
+    cache_get_stats(&prefix);
+    printf("Forked %d branches after %lu references (hits: %llu, misses: %llu)\n", num_branches, first,
+           prefix.hits, prefix.misses);
+    int ok = 1;
+    for (int b = 0; b < num_branches; b++) {
+        struct branch_result result;
+        if (read(pipes[b], &result, sizeof(result)) != sizeof(result) || !result.ok) {
+            printf("Branch %d %s%s: failed\n", b, policy_names[branches[b]], branch_admission[b] ? "+tinylfu" : "");
+            ok = 0;
+        } else {
+            struct cache_stats total = prefix;
+            cache_stats_merge(&total, &result.stats);
+            char policy[32];
+            snprintf(policy, sizeof(policy), "%s%s", policy_names[branches[b]], branch_admission[b] ? "+tinylfu" : "");
+            report_branch(b, policy, &total, num_refs, prefix_seconds + result.seconds);
+            printf("Branch %d %s%s: hits: %llu, misses: %llu -- hit rate %.2f%% (whole run %.2f%%)", b,
+                   policy_names[branches[b]], branch_admission[b] ? "+tinylfu" : "", result.stats.hits,
+                   result.stats.misses, result.stats.refs ? 100.0 * result.stats.hits / result.stats.refs : 0.0,
+                   total.refs ? 100.0 * total.hits / total.refs : 0.0);
+            if (branch_admission[b]) {
+                printf(", admitted: %llu, rejected: %llu", result.admitted, result.rejected);
+            }
+            printf("\n");
+        }
+        close(pipes[b]);
+        waitpid(pids[b], 0, 0);
+    }
+    free(suffix);
+    return ok;
+}
+
+/* Reads the next address of the trace of a SimPoint run: from stdin, or from the file the addresses
+ * were spilled to.  Returns 1 on success and 0 at the end of the trace.
+ */
+static int next_ref(FILE *trace, unsigned int *address) {
+    return trace == stdin ? scanf("%u", address) == 1 : fread(address, sizeof(*address), 1, trace) == 1;
+}
+
+/* Simulates only the representative intervals of references first..num_refs-1 and extrapolates
+ * the hit rate of the whole trace from them.  Each interval is preceded by functional warming
+ * with the interval before it, the other intervals are skipped.  The trace is read twice and never
+ * held in memory: the first pass builds the interval vectors and remembers where each interval
+ * starts, the second seeks to the intervals it warms and simulates.  A trace that can't seek
+ * (a pipe) is spilled to a temporary file of binary addresses in the first pass.
+ */
+static int run_simpoints(unsigned long first, unsigned long num_refs) {
+    unsigned long count = num_refs - first;
+    unsigned long num_intervals = (count + simpoint_length - 1) / simpoint_length;
+    long *starts = malloc((num_intervals + 1) * sizeof(long));  // where each interval starts in the trace
+    if (!starts || !simpoint_init(count, simpoint_length)) {
+        printf("Error allocating the SimPoint intervals\n");
+        free(starts);
+        return 0;
+    }
+    FILE *trace = ftell(stdin) < 0 ? tmpfile() : stdin;
+    if (!trace) {
+        printf("Error creating the SimPoint trace file\n");
+        free(starts);
+        return 0;
+    }
+
+    for (unsigned long i = 0; i < count; i++) {
+        unsigned int address;
+        if (i % simpoint_length == 0) {
+            starts[i / simpoint_length] = trace == stdin ? ftell(stdin) : (long) (i * sizeof(address));
+        }
+        if (scanf("%u", &address) != 1 ||
+            (trace != stdin && fwrite(&address, sizeof(address), 1, trace) != 1)) {
+            printf("Error reading operation\n");
+            free(starts);
+            return 0;
+        }
+        simpoint_add(address);
+    }
+    long end = ftell(stdin);  // the rest of the trace, read once the intervals are done
+
+    struct simpoint points[SIMPOINT_MAX_K];
+    int num_points = simpoint_select(simpoint_k, points);
+
+    double rate = 0;        // the weighted hit rate of the representative intervals
+    unsigned long done = 0; // the references up to here are already in the cache
+    int ok = 1;
+    for (int p = 0; ok && p < num_points; p++) {
+        unsigned long begin = points[p].interval * simpoint_length;
+        unsigned long end_ref = begin + simpoint_length < count ? begin + simpoint_length : count;
+
+        // the warming starts at an interval, either the one before or the end of the last one simulated
+        unsigned long i = begin > simpoint_length && begin - simpoint_length > done ? begin - simpoint_length : done;
+        if (fseek(trace, starts[i / simpoint_length], SEEK_SET)) {
+            printf("Error seeking the trace\n");
+            ok = 0;
+            break;
+        }
+
+        unsigned int address;
+        for (; i < begin && (ok = next_ref(trace, &address)); i++) {
+            cache_warm(address);
+        }
+
+        struct cache_stats start, end_stats, part;
+        cache_get_stats(&start);
+        for (; ok && i < end_ref; i++) {
+            ok = next_ref(trace, &address) && simulate(address, 1);
+        }
+        done = end_ref;
+        if (!ok) {
+            break;
+        }
+
+        cache_get_stats(&end_stats);
+        cache_stats_diff(&part, &end_stats, &start);
+        double interval_rate = part.refs ? (double)part.hits / part.refs : 0;
+        rate += points[p].weight * interval_rate;
+        printf("SimPoint interval %lu weight %.4f: hits: %llu, misses: %llu -- hit rate %.2f%%\n", points[p].interval,
+               points[p].weight, part.hits, part.misses, 100 * interval_rate);
+    }
+    free(starts);
+    if (trace != stdin) {
+        fclose(trace);
+    } else if (fseek(stdin, end, SEEK_SET)) {
+        ok = 0;
+    }
+    if (!ok) {
+        return 0;
+    }
+
+    printf("Estimated hit rate %.2f%% (hits: %.0f, misses: %.0f) from %d of %lu intervals\n", 100 * rate,
+           rate * count, (1 - rate) * count, num_points, num_intervals);
+    return 1;
+}
+
+/* Simulates the object cache: reads the capacity in bytes, the number of requests and the
+ * key size records (time key size ttl with --ttl), and prints the object and byte hit rates.  Nothing is printed per request,
+ * object traces are typically far too long for that.
+ */
+static int run_objects(double run_start) {
+    unsigned long long capacity;
+    unsigned long num_refs;
+    if (scanf("%llu", &capacity) != 1) {
+        printf("Error reading cache capacity\n");
+        return 0;
+    }
+    if (scanf("%lu", &num_refs) != 1) {
+        printf("Error reading number of references\n");
+        return 0;
+    }
+    progress_time = run_start;
+    if (!objcache_init(capacity, object_policy, admission)) {
+        printf("Error allocating the object cache\n");
+        return 0;
+    }
+
+    for (unsigned long i = 0; i < num_refs; i++) {
+        unsigned long long key;
+        unsigned int size, time, ttl = 0;
+        if (object_ttl ? scanf("%u %llu %u %u", &time, &key, &size, &ttl) != 4 : scanf("%llu %u", &key, &size) != 2) {
+            printf("Error reading operation\n");
+            return 0;
+        }
+        poll_status(i, 0, num_refs, run_start);
+        if (object_ttl) {
+            objcache_advance(time);
+        }
+        objcache_get(key, size, ttl);
+    }
+
+    struct objcache_stats stats;
+    objcache_get_stats(&stats);
+    printf("Object hits: %llu, misses: %llu -- hit rate %.2f%%, byte hit rate %.2f%%\n", stats.hits, stats.misses,
+           stats.refs ? 100.0 * stats.hits / stats.refs : 0.0,
+           stats.bytes ? 100.0 * (stats.bytes - stats.byte_misses) / stats.bytes : 0.0);
+    printf("Object evictions: %llu, too large to cache: %llu\n", stats.evictions, stats.too_large);
+    if (admission) {
+        printf("Object admission: admitted: %llu, rejected: %llu\n", stats.admitted, stats.rejected);
+    }
+    if (object_ttl) {
+        printf("Object expirations: %llu, expired misses: %llu\n", stats.expired, stats.expired_misses);
+    }
+
+    struct cache_stats summary;
+    current_stats(&summary);
+    report_close(&summary, num_refs, now() - run_start, 0);
+    objcache_free();
+    return 1;
+}
+
+/* Rewrites the whole blocks of main memory with --memory mixed, by block id modulo 8: zeros, narrow
+ * sign-extended bytes, one of four 8-byte values repeated, 8-byte pointers near one base, FPC patterns
+ * (repeated bytes, zero-padded halfwords, small values), a copy of the first such block, and the random
+ * words twice.  Every BDI and FPC encoding and every kind of duplicate then shows up in a trace.
+ */
+static void mix_memory(void) {
+    for (unsigned int block = 0; (block + 1) * 64 <= c_info.M_size; block++) {
+        unsigned char *data = (unsigned char *)memory + block * 64;
+        unsigned int words[16];
+        unsigned long long longs[8];
+        memcpy(words, data, sizeof(words));
+        for (int w = 0; w < 16; w++) {
+            switch (block % 8) {
+            case 0:
+                words[w] = 0;
+                break;
+            case 1:
+                words[w] = (unsigned int)(int)(signed char)words[w];
+                break;
+            case 4:
+                words[w] = w % 3 == 0 ? 0x01010101u * (words[w] & 0xff) : w % 3 == 1 ? words[w] << 16 : words[w] & 0x7;
+                break;
+            }
+        }
+        for (int l = 0; l < 8; l++) {
+            longs[l] = block % 8 == 2 ? 0x0123456789abcdefULL * (block / 8 % 4 + 1)
+                                      : 0x00007f3a00000000ULL + block * 64 + (words[l] & 0x7f);
+        }
+        if (block % 8 == 2 || block % 8 == 3) {
+            memcpy(data, longs, sizeof(longs));
+        } else if (block % 8 == 5 && block > 5) {
+            memcpy(data, (unsigned char *)memory + 5 * 64, 64);
+        } else if (block % 8 < 5) {
+            memcpy(data, words, sizeof(words));
+        }
+    }
+}
+
+/* Allocates the main memory of c_info.M_size bytes and fills it with the same pseudo-random words
+ * on every run, so the words the cache returns can be checked.  --memory mixed turns them into
+ * compressible blocks afterwards.
+ */
+static void init_memory(void) {
+    memory = calloc(c_info.M_size + sizeof(long), 1);
+    assert(memory);
+    srandom(0xc0ffeed);
+    for (int i = 0; i < c_info.M_size; i += 4) {
+        *(unsigned long *)(memory + i) = random();
+    }
+    if (memory_fill == FILL_MIXED) {
+        mix_memory();
+    }
+}
+
+/* Opens the --stats-file, if any, echoing the configuration of the cache in its records: the block
+ * cache, or the object cache with --objects, which only has a policy, an admission filter and a warmup.
+ * Returns 1 on success and 0 on failure.
+ */
+static int open_stats(void) {
+    if (stats_file) {
+        report_config.F_size = c_info.F_size;
+        report_config.M_size = c_info.M_size;
+        report_config.policy = objects ? object_policy_names[object_policy] : policy_names[c_info.policy];
+        report_config.warmup = warmup_text;
+        report_config.interval = interval;
+        report_config.sample_period = sample_period;
+        report_config.sample_unit = sample_unit;
+        report_config.ways = c_info.ways;
+        report_config.index = index_names[c_info.index];
+        report_config.insertion = insertion_names[c_info.insertion];
+        report_config.admission = admission ? "tinylfu" : "none";
+        report_config.compression = compression_names[c_info.compression];
+        report_config.tenants = c_info.tenants;
+        report_config.dedup = c_info.dedup;
+        report_config.sectors = c_info.sectors;
+        report_config.values = c_info.values;
+        report_config.memory = fill_names[memory_fill];
+        report_config.dram = dram.queue ? &dram : 0;
+        report_config.page = page_names[dram.page];
+        if (!report_open(stats_file, stats_format, &report_config)) {
+            printf("Error opening stats file %s\n", stats_file);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Opens the trace of a program and reads its header: the fast memory size, the main memory size
+ * and the number of references.  Returns 1 on success and 0 on failure.
+ */
+static int open_program(struct program *program, const char *file, unsigned int *F_size, unsigned int *M_size) {
+    program->trace = fopen(file, "r");
+    program->done = 0;
+    if (!program->trace) {
+        return 0;
+    }
+    if (fscanf(program->trace, "%u %u %lu", F_size, M_size, &program->num_refs) != 3) {
+        fclose(program->trace);
+        program->trace = 0;
+        return 0;
+    }
+    return 1;
+}
+
+/* Simulates the next reference of a program.  Returns 1 if it missed, 0 if it hit and -1 on failure. */
+static int step_program(struct program *program) {
+    unsigned int address;
+    if (fscanf(program->trace, "%u", &address) != 1) {
+        printf("Error reading operation\n");
+        return -1;
+    }
+    struct cache_stats before, after;
+    cache_get_stats(&before);
+    if (!simulate(address, 0)) {
+        return -1;
+    }
+    cache_get_stats(&after);
+    program->done++;
+    return after.misses != before.misses;
+}
+
+/* Simulates a multi-programmed workload: the traces of the --program files take turns on one cache,
+ * each for a quantum of references or a time slice of cycles, and every switch flushes the cache or
+ * not as --switch says.  The traces are read one reference at a time, so memory stays bounded.
+ * Afterwards every program runs alone on an empty cache of the same geometry, and the extra misses
+ * of the shared run are reported as its interference.
+ */
+static int run_programs(double run_start) {
+    struct program programs[CACHE_MAX_TENANTS];
+    unsigned long total = 0;  // the references of all the programs
+    for (int p = 0; p < num_programs; p++) {
+        unsigned int F_size, M_size;
+        if (!open_program(&programs[p], program_files[p], &F_size, &M_size)) {
+            printf("Error reading program %s\n", program_files[p]);
+            return 0;
+        }
+        if (p && F_size != c_info.F_size) {
+            printf("Error: program %s has a different fast memory size\n", program_files[p]);
+            return 0;
+        }
+        c_info.F_size = F_size;
+        c_info.M_size = M_size > c_info.M_size ? M_size : c_info.M_size;
+        total += programs[p].num_refs;
+    }
+    c_info.F_memory = calloc(1, c_info.F_size);
+    assert(c_info.F_memory);
+    init_memory();
+    if (!open_stats()) {
+        return 0;
+    }
+    progress_time = run_start;
+
+    // the programs take turns until all of them are done
+    unsigned long ref = 0;       // the references simulated so far
+    unsigned long switches = 0;  // the switches between two programs
+    int remaining = num_programs;
+    for (int current = 0; remaining;) {
+        struct program *program = &programs[current];
+        c_info.tenant = current;
+
+        unsigned long turn = 0;  // the references or cycles of this turn so far
+        while (program->done < program->num_refs && turn < (time_slice ? time_slice : quantum)) {
+            poll_status(ref++, 0, total, run_start);
+            int missed = step_program(program);
+            if (missed < 0) {
+                return 0;
+            }
+            turn += time_slice && missed ? MISS_CYCLES : 1;
+        }
+        if (program->trace && program->done == program->num_refs) {
+            fclose(program->trace);
+            program->trace = 0;
+            remaining--;
+        }
+
+        int next = current;
+        while (remaining && !programs[next = (next + 1) % num_programs].trace) {
+        }
+        if (remaining && next != current && turn) {
+            switches++;
+            if (switch_mode == SWITCH_FLUSH) {
+                cache_flush();
+            }
+        }
+        current = next;
+    }
+
+    struct cache_stats stats;
+    struct cache_tenant_stats shared[CACHE_MAX_TENANTS];
+    cache_get_stats(&stats);
+    for (int p = 0; p < num_programs; p++) {
+        cache_get_tenant_stats(p, &shared[p]);
+    }
+    close_stats(&stats, total, now() - run_start);
+    report_stats(&stats);
+    printf("Context switches: %lu (switch %s)\n", switches, switch_names[switch_mode]);
+
+    /* run every program alone on an empty cache with the same tenants, so the geometry is that of the
+     * shared run: the program may fill every way, and UCP keeps its shadow tags but never repartitions
+     */
+    unsigned int way_mask[CACHE_MAX_TENANTS];
+    unsigned int ucp_interval = c_info.ucp_interval;
+    memcpy(way_mask, c_info.way_mask, sizeof(way_mask));
+    memset(c_info.way_mask, 0, sizeof(c_info.way_mask));
+    c_info.ucp_interval = ucp_interval ? UINT_MAX : 0;
+    for (int p = 0; p < num_programs; p++) {
+        unsigned int F_size, M_size;
+        memset(c_info.F_memory, 0, c_info.F_size);
+        c_info.tenant = p;
+        if (!open_program(&programs[p], program_files[p], &F_size, &M_size)) {
+            printf("Error reading program %s\n", program_files[p]);
+            return 0;
+        }
+        while (programs[p].done < programs[p].num_refs) {
+            if (step_program(&programs[p]) < 0) {
+                return 0;
+            }
+        }
+        fclose(programs[p].trace);
+
+        struct cache_stats alone;
+        cache_get_stats(&alone);
+        const struct cache_stats *own = &shared[p].stats;
+        long long extra = (long long)own->misses - (long long)alone.misses;
+        printf("Program %d %s: misses: %llu, alone: %llu -- hit rate %.2f%%, alone %.2f%%, interference: %+lld misses "
+               "(%+.2f%%)\n", p, program_files[p], own->misses, alone.misses,
+               own->refs ? 100.0 * own->hits / own->refs : 0.0, alone.refs ? 100.0 * alone.hits / alone.refs : 0.0,
+               extra, alone.misses ? 100.0 * extra / alone.misses : 0.0);
+    }
+    memcpy(c_info.way_mask, way_mask, sizeof(way_mask));
+    c_info.ucp_interval = ucp_interval;
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
     setbuf(stdout, 0);
 
+    if (!parse_options(argc, argv)) {
+        return 0;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_dump;
+    action.sa_flags = SA_RESTART;  // don't interrupt reading the trace
+    sigaction(SIGUSR1, &action, 0);  // before any mode starts, or SIGUSR1 kills it
+
+    // the object cache has its own trace format, the capacity is in bytes and there is no main memory
+    if (objects) {
+        if (!open_stats()) {
+            return 0;
+        }
+        run_objects(now());
+        return 0;
+    }
+
+    // a multi-programmed run reads its traces from the --program files
+    if (num_programs) {
+        run_programs(now());
+        return 0;
+    }
+
     if (scanf("%d", &c_info.F_size) != 1) {
         printf("Error reading fast memory size\n");
         return 0;
@@ -34,57 +1507,173 @@ int main() {
         return 0;
     }
 
-    memory = calloc(c_info.M_size + sizeof(long), 1);
-    assert(memory);
-    srandom(0xc0ffeed);
-    for (int i = 0; i < c_info.M_size; i += 4) {
-        *(unsigned long *)(memory + i) = random();
+    init_memory();
+    if (c_info.values && !values_init(c_info.values, c_info.M_size)) {
+        printf("Error allocating the value analysis\n");
+        return 0;
+    }
+    if (dram.queue && !dram_init(&dram)) {
+        printf("Error allocating the DRAM banks\n");
+        return 0;
     }
 
-    int num_refs = 0;
-    if (scanf("%d", &num_refs) != 1) {
+    unsigned long num_refs = 0;
+    if (scanf("%lu", &num_refs) != 1) {
         printf("Error reading number of references\n");
         return 0;
     }
 
-    for (int i = 0; i < num_refs; i++) {
+    /* resume from a checkpoint: restore the cache and the counters, and skip
+     * the references that were simulated before the checkpoint was taken
+     */
+    unsigned long first_ref = 0;
+    if (restore_file) {
+        void *F_memory = c_info.F_memory;
+        struct checkpoint_state state;
+        if (!checkpoint_restore(restore_file, &state)) {
+            printf("Error restoring checkpoint %s: it can't be read, or it was saved by another version or "
+                   "configuration\n", restore_file);
+            return 0;
+        }
+        if (c_info.F_memory != F_memory) {
+            free(F_memory);
+        }
+        if (state.refs > num_refs) {
+            printf("Error: checkpoint %s is past the end of the trace\n", restore_file);
+            return 0;
+        }
+        for (first_ref = 0; first_ref < state.refs; first_ref++) {
+            unsigned int address;
+            if ((c_info.tenants && scanf("%u", &c_info.tenant) != 1) || scanf("%u", &address) != 1) {
+                printf("Error reading operation\n");
+                return 0;
+            }
+        }
+        cache_get_stats(&interval_start);
+    }
+
+    // when forking, only the warm-up prefix is simulated here, the branches run the rest
+    unsigned long last_ref = num_refs;
+    if (num_branches) {
+        if (fork_at < first_ref || fork_at > num_refs) {
+            printf("Error: --fork-at %lu is outside the trace\n", fork_at);
+            return 0;
+        }
+        last_ref = fork_at;
+    }
+
+    // simpoints need the whole trace before anything is simulated
+    if (simpoint_length) {
+        last_ref = first_ref;
+    }
+
+    if (!open_stats()) {
+        return 0;
+    }
+
+    double start = now();
+    double run_start = start;
+    interval_time = start;
+    progress_time = start;
+    for (unsigned long i = first_ref; i < last_ref; i++) {
         unsigned int address;
-        if (scanf("%u", &address) != 1) {
+        if ((c_info.tenants && scanf("%u", &c_info.tenant) != 1) || scanf("%u", &address) != 1) {
             printf("Error reading operation\n");
             return 0;
         }
+        if (c_info.tenants && c_info.tenant >= c_info.tenants) {
+            printf("Error: tenant %u is out of range\n", c_info.tenant);
+            return 0;
+        }
 
-        assert(address <= c_info.M_size);
+        poll_status(i, first_ref, num_refs, run_start);
 
-        unsigned long word;
-        miss = 0;
-        cache_get(address, &word);
-        unsigned long expected = *(unsigned long *)(memory + address);
+        /* a sampled run only warms the cache outside of the units, the time of each
+         * mode is taken when the run switches between them
+         */
+        int detailed = 1;
+        if (sample_period) {
+            unsigned long phase = i % sample_period;
+            detailed = phase >= sample_period - sample_unit;
+            if (detailed != in_detail) {
+                double end = now();
+                *(in_detail ? &detailed_time : &warming_time) += end - start;
+                start = end;
+                in_detail = detailed;
+            }
+            if (phase == sample_period - sample_unit) {
+                cache_get_stats(&unit_start);
+            }
+            *(detailed ? &detailed_refs : &warming_refs) += 1;
+        }
 
-        if (word != expected) {
-            printf("Error reading memory address 0x%8.8x\n", address);
-            printf("  Expected 0x%16.16lx\n", expected);
-            printf("  Actual 0x%16.16lx\n", word);
-            return 0;
+        // a warmed reference still counts for the checkpoint below
+        if (!detailed) {
+            cache_warm(address);
+        } else {
+            check_warmup(i);
+            if (!simulate(address, 1)) {
+                return 0;
+            }
+            if (sample_period && i % sample_period == sample_period - 1) {
+                end_unit();
+            }
         }
 
-        log_result(address);
+        if (checkpoint_file && i + 1 == checkpoint_at) {
+            struct checkpoint_state state = {checkpoint_at};
+            if (!checkpoint_save(checkpoint_file, &state)) {
+                printf("Error saving checkpoint %s\n", checkpoint_file);
+                return 0;
+            }
+        }
+    }
 
-        printf("Loaded value [0x%16.16lx] @ address 0x%8.8x\n", word, address);
+    if (num_branches) {
+        struct cache_stats stats;
+        cache_get_stats(&stats);
+        double prefix_seconds = now() - run_start;
+        run_branches(last_ref, num_refs, prefix_seconds);
+        close_stats(&stats, last_ref - first_ref, prefix_seconds);
+        return 0;
+    }
+
+    if (simpoint_length && !run_simpoints(last_ref, num_refs)) {
+        return 0;
     }
 
+    // the last interval may be partial
+    if (interval) {
+        log_interval();
+    }
+
+    if (sample_period) {
+        *(in_detail ? &detailed_time : &warming_time) += now() - start;
+        report_sampling();
+    }
+
+    struct cache_stats stats;
+    cache_get_stats(&stats);
+    close_stats(&stats, num_refs - first_ref, now() - run_start);
+
     char buffer[10];
     if (scanf("%9s", buffer) == 1 && !strcmp(buffer, "stats")) {
-        printf("Cache hits: %d, misses: %d -- hit rate %d%%\n", hits, misses, 100 * hits / num_refs);
+        report_stats(&stats);
     }
     return 0;
 }
 
-extern unsigned int memget(unsigned int address, void *buffer, unsigned int size) {
+extern unsigned int mempeek(unsigned int address, void *buffer, unsigned int size) {
     if (address + size > c_info.M_size) {
         size = c_info.M_size - address;
     }
     memcpy(buffer, memory + address, size);
+    return size;
+}
+
+extern unsigned int memget(unsigned int address, void *buffer, unsigned int size) {
+    size = mempeek(address, buffer, size);
+    dram_access(address);
     miss++;
     return size;
 }
@@ -0,0 +1,669 @@
+/**
+ * @author hongh233
+ * @description: This C program will implement an object cache (a key-value cache) that simulates
+ * caching variable-size objects in a capacity given in bytes, to size caches like memcached or redis.
+ * Objects are found with a hash table in O(1), and replaced with LRU, S3-FIFO or LFU,
+ * optionally behind a TinyLFU admission filter.  Objects with a TTL are expired by a hierarchical timer wheel.
+ * The metadata grows with the number of resident objects only, and entries are addressed by 32-bit indices.
+ */
+
+#include "objcache.h"
+#include "tinylfu.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NIL 0                // the index of no entry, entry 0 is never used
+#define LFU_MAX_FREQ 250     // LFU counts saturate here, one queue per count
+#define S3FIFO_MAX_FREQ 3    // S3-FIFO counts saturate here (2 bits)
+#define QUEUE_SMALL 0        // S3-FIFO: the small FIFO new objects enter
+#define QUEUE_MAIN 1         // S3-FIFO: the main FIFO of objects reused in the small FIFO
+#define QUEUE_GHOST 2        // S3-FIFO: the keys recently evicted from the small FIFO
+#define QUEUE_EXPIRED 253    // the keys recently expired, so their next miss is counted as an expired miss
+#define QUEUE_DETACHED 254   // an entry that is briefly on no queue
+#define QUEUE_FREE 255       // an entry on the free list
+#define WHEEL_LEVELS 4       // the levels of the timer wheel, 8 bits of the expiry time each
+#define WHEEL_SLOTS 256      // the slots of each level of the timer wheel
+#define MIN_TOMBSTONES 1024  // expired keys kept beyond one per resident object
+
+/* typedef struct obj_entry, represent one object of the cache, or one ghost key
+ * @params: unsigned long long key: the key of the object
+ * @params: unsigned int size: the size of the object in bytes
+ * @params: unsigned int prev: the previous entry of the queue, towards the head
+ * @params: unsigned int next: the next entry of the queue, towards the tail, or of the free list
+ * @params: unsigned int chain: the next entry of the same hash bucket
+ * @params: unsigned int expire: the time the object expires at, 0 if it never expires (it is on the timer wheel)
+ * @params: unsigned int timerPrev: the previous entry of the same timer wheel slot
+ * @params: unsigned int timerNext: the next entry of the same timer wheel slot
+ * @params: unsigned short timerSlot: the timer wheel slot the entry is on
+ * @params: unsigned char freq: the access count (S3-FIFO and LFU)
+ * @params: unsigned char queue: the queue the entry is on
+ */
+typedef struct obj_entry {
+    unsigned long long key;
+    unsigned int size;
+    unsigned int prev;
+    unsigned int next;
+    unsigned int chain;
+    unsigned int expire;
+    unsigned int timerPrev;
+    unsigned int timerNext;
+    unsigned short timerSlot;
+    unsigned char freq;
+    unsigned char queue;
+} obj_entry;
+
+/* typedef struct obj_queue, represent a doubly-linked queue of entries, new entries enter at the head
+ * @params: unsigned int head: the most recently inserted entry
+ * @params: unsigned int tail: the least recently inserted entry
+ * @params: unsigned int count: the number of entries
+ * @params: unsigned long long bytes: the sum of the sizes of the entries
+ */
+typedef struct obj_queue {
+    unsigned int head;
+    unsigned int tail;
+    unsigned int count;
+    unsigned long long bytes;
+} obj_queue;
+
+static obj_entry *entries;          // all the entries, grown by doubling
+static unsigned int numEntries;     // the entries handed out so far, including entry 0
+static unsigned int maxEntries;     // the allocated entries
+static unsigned int freeList;       // the first free entry, linked by next
+static unsigned int *buckets;       // the first entry of each hash bucket
+static unsigned int bucketMask;     // the number of buckets - 1, a power of 2 - 1
+static unsigned int numKeys;        // the entries in the hash table
+static obj_queue queues[256];       // the queues of the policy, indexed by obj_entry.queue
+static unsigned long long capacity; // the capacity in bytes
+static unsigned long long used;     // the bytes of the resident objects
+static unsigned long long smallTarget; // S3-FIFO: the capacity of the small FIFO
+static unsigned int minFreq;        // LFU: no queue below this one holds an entry
+static int policy;
+static struct tinylfu *filter;      // the admission filter, NULL for none
+static unsigned int wheel[WHEEL_LEVELS * WHEEL_SLOTS]; // the first entry of each timer wheel slot
+static unsigned int wheelTime;      // the current time, the wheel expired everything up to it
+static unsigned int numTimers;      // the entries on the timer wheel
+static unsigned int levelTimers[WHEEL_LEVELS]; // the entries on each level of the timer wheel
+static struct objcache_stats stats;
+
+
+/* unsigned int function, hash a key to its bucket with the splitmix64 finalizer
+ * @params: unsigned long long key: the key
+ * @return: the index of the bucket
+ */
+static unsigned int bucket_of(unsigned long long key) {
+
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return (unsigned int)(key ^ (key >> 31)) & bucketMask;
+}
+
+
+/* unsigned int function, find the entry of a key
+ * @params: unsigned long long key: the key
+ * @return: the index of the entry, NIL if the key isn't in the cache
+ */
+static unsigned int find(unsigned long long key) {
+
+    unsigned int i = buckets[bucket_of(key)];
+    while (i != NIL && entries[i].key != key) {
+        i = entries[i].chain;
+    }
+    return i;
+}
+
+
+/* int function, double the hash table and rehash every entry, so the chains stay short
+ * @return: 1 on success and 0 if the table can't be allocated
+ */
+static int grow_buckets(void) {
+
+    unsigned int *bigger = calloc(2 * (unsigned long)(bucketMask + 1), sizeof(unsigned int));
+    if (!bigger) {
+        return 0;
+    }
+    free(buckets);
+    buckets = bigger;
+    bucketMask = 2 * bucketMask + 1;
+
+    for (unsigned int i = 1; i < numEntries; i++) {
+        if (entries[i].queue != QUEUE_FREE) {
+            unsigned int b = bucket_of(entries[i].key);
+            entries[i].chain = buckets[b];
+            buckets[b] = i;
+        }
+    }
+    return 1;
+}
+
+
+/* unsigned int function, take an entry from the free list, or a new one, and add its key to the hash table
+ * @params: unsigned long long key: the key of the entry
+ * @return: the index of the entry, NIL if memory is exhausted
+ */
+static unsigned int new_entry(unsigned long long key) {
+
+    if (numKeys > bucketMask && !grow_buckets()) {
+        return NIL;
+    }
+
+    unsigned int i = freeList;
+    if (i != NIL) {
+        freeList = entries[i].next;
+    } else {
+        if (numEntries == maxEntries) {
+            obj_entry *bigger = maxEntries <= 0x7fffffff ?
+                                realloc(entries, 2 * (unsigned long)maxEntries * sizeof(obj_entry)) : 0;
+            if (!bigger) {
+                return NIL;
+            }
+            entries = bigger;
+            maxEntries *= 2;
+        }
+        i = numEntries++;
+    }
+
+    unsigned int b = bucket_of(key);
+    entries[i].key = key;
+    entries[i].chain = buckets[b];
+    entries[i].queue = QUEUE_DETACHED;
+    buckets[b] = i;
+    numKeys++;
+    return i;
+}
+
+
+/* void function, remove an entry (on no queue) from the hash table and put it on the free list
+ * @params: unsigned int i: the index of the entry
+ * @return: none
+ */
+static void free_entry(unsigned int i) {
+
+    unsigned int *link = &buckets[bucket_of(entries[i].key)];
+    while (*link != i) {
+        link = &entries[*link].chain;
+    }
+    *link = entries[i].chain;
+    numKeys--;
+
+    entries[i].queue = QUEUE_FREE;
+    entries[i].next = freeList;
+    freeList = i;
+}
+
+
+/* void function, insert an entry at the head of a queue
+ * @params: unsigned int i: the index of the entry, on no queue
+ * @params: unsigned char q: the queue
+ * @return: none
+ */
+static void push(unsigned int i, unsigned char q) {
+
+    obj_queue *queue = &queues[q];
+    entries[i].queue = q;
+    entries[i].prev = NIL;
+    entries[i].next = queue->head;
+    if (queue->head != NIL) {
+        entries[queue->head].prev = i;
+    } else {
+        queue->tail = i;
+    }
+    queue->head = i;
+    queue->count++;
+    queue->bytes += entries[i].size;
+}
+
+
+/* void function, take an entry off its queue
+ * @params: unsigned int i: the index of the entry
+ * @return: none
+ */
+static void unlink_entry(unsigned int i) {
+
+    obj_entry *e = &entries[i];
+    obj_queue *queue = &queues[e->queue];
+    if (e->prev != NIL) {
+        entries[e->prev].next = e->next;
+    } else {
+        queue->head = e->next;
+    }
+    if (e->next != NIL) {
+        entries[e->next].prev = e->prev;
+    } else {
+        queue->tail = e->prev;
+    }
+    queue->count--;
+    queue->bytes -= e->size;
+    e->queue = QUEUE_DETACHED;
+}
+
+
+/* void function, put an entry with an expiry time on the timer wheel: level 0 holds the entries that
+ * expire within 256 ticks, one slot per tick, and each next level 256 times longer spans, which are
+ * cascaded down a level when the time reaches them (like the Linux kernel timers)
+ * @params: unsigned int i: the index of the entry
+ * @return: none
+ */
+static void wheel_add(unsigned int i) {
+
+    obj_entry *e = &entries[i];
+    unsigned int delta = e->expire - wheelTime;
+    int level = delta < 1u << 8 ? 0 : delta < 1u << 16 ? 1 : delta < 1u << 24 ? 2 : 3;
+    unsigned int slot = level * WHEEL_SLOTS + ((e->expire >> (8 * level)) & (WHEEL_SLOTS - 1));
+
+    e->timerSlot = slot;
+    e->timerPrev = NIL;
+    e->timerNext = wheel[slot];
+    if (wheel[slot] != NIL) {
+        entries[wheel[slot]].timerPrev = i;
+    }
+    wheel[slot] = i;
+    numTimers++;
+    levelTimers[level]++;
+}
+
+
+/* void function, take an entry off the timer wheel, if it is on it
+ * @params: unsigned int i: the index of the entry
+ * @return: none
+ */
+static void wheel_remove(unsigned int i) {
+
+    obj_entry *e = &entries[i];
+    if (!e->expire) {
+        return;
+    }
+    if (e->timerPrev != NIL) {
+        entries[e->timerPrev].timerNext = e->timerNext;
+    } else {
+        wheel[e->timerSlot] = e->timerNext;
+    }
+    if (e->timerNext != NIL) {
+        entries[e->timerNext].timerPrev = e->timerPrev;
+    }
+    e->expire = 0;
+    numTimers--;
+    levelTimers[e->timerSlot / WHEEL_SLOTS]--;
+}
+
+
+/* void function, drop a resident object from the cache
+ * @params: unsigned int i: the index of the entry
+ * @return: none
+ */
+static void drop(unsigned int i) {
+
+    used -= entries[i].size;
+    wheel_remove(i);
+    unlink_entry(i);
+    free_entry(i);
+}
+
+
+/* void function, S3-FIFO: remember the key of an object evicted from the small FIFO, forgetting
+ * the oldest keys once the ghosts add up to more than the main FIFO can hold
+ * @params: unsigned int i: the index of the entry, on no queue
+ * @return: none
+ */
+static void make_ghost(unsigned int i) {
+
+    used -= entries[i].size;
+    wheel_remove(i);
+    push(i, QUEUE_GHOST);
+    while (queues[QUEUE_GHOST].bytes > capacity - smallTarget) {
+        unsigned int oldest = queues[QUEUE_GHOST].tail;
+        unlink_entry(oldest);
+        free_entry(oldest);
+    }
+}
+
+
+/* void function, S3-FIFO eviction: objects leave the small FIFO unless they were reused there, then
+ * they move to the main FIFO; the main FIFO gives reused objects another round (CLOCK-like)
+ * @return: none
+ */
+static void evict_s3fifo(void) {
+
+    for (;;) {
+        if (queues[QUEUE_SMALL].bytes > smallTarget || queues[QUEUE_MAIN].count == 0) {
+            unsigned int i = queues[QUEUE_SMALL].tail;
+            unlink_entry(i);
+            if (entries[i].freq > 0) {
+                entries[i].freq = 0;
+                push(i, QUEUE_MAIN);
+                continue;
+            }
+            make_ghost(i);
+            return;
+        }
+
+        unsigned int i = queues[QUEUE_MAIN].tail;
+        if (entries[i].freq > 0) {
+            entries[i].freq--;
+            unlink_entry(i);
+            push(i, QUEUE_MAIN);
+            continue;
+        }
+        drop(i);
+        return;
+    }
+}
+
+
+/* void function, evict one object according to the policy
+ * @return: none
+ */
+static void evict(void) {
+
+    stats.evictions++;
+    switch (policy) {
+    case OBJCACHE_S3FIFO:
+        evict_s3fifo();
+        break;
+    case OBJCACHE_LFU:
+        // the least frequently used objects, the least recently inserted of them first
+        while (queues[minFreq].count == 0) {
+            minFreq++;
+        }
+        drop(queues[minFreq].tail);
+        break;
+    default:
+        drop(queues[0].tail);
+        break;
+    }
+}
+
+
+/* unsigned int function, find the object the policy would evict next, without evicting it
+ * (S3-FIFO may still move a few objects before it finds its actual victim)
+ * @return: the index of the entry
+ */
+static unsigned int next_victim(void) {
+
+    switch (policy) {
+    case OBJCACHE_S3FIFO:
+        if (queues[QUEUE_SMALL].bytes > smallTarget || queues[QUEUE_MAIN].count == 0) {
+            return queues[QUEUE_SMALL].tail;
+        }
+        return queues[QUEUE_MAIN].tail;
+    case OBJCACHE_LFU:
+        while (queues[minFreq].count == 0) {
+            minFreq++;
+        }
+        return queues[minFreq].tail;
+    default:
+        return queues[0].tail;
+    }
+}
+
+
+/* void function, record a request in the admission filter, which is rebuilt twice as large once the
+ * cache holds more keys than it has counters per row (like Caffeine, the history is lost then)
+ * @params: unsigned long long key: the key of the request
+ * @return: none
+ */
+static void record(unsigned long long key) {
+
+    if (numKeys > filter->width) {
+        struct tinylfu *bigger = malloc(tinylfu_size(2 * numKeys));
+        if (bigger) {
+            tinylfu_init(bigger, 2 * numKeys);
+            free(filter);
+            filter = bigger;
+        }
+    }
+    tinylfu_record(filter, key);
+}
+
+
+/* void function, update the policy state of a resident object on a hit
+ * @params: unsigned int i: the index of the entry
+ * @return: none
+ */
+static void touch(unsigned int i) {
+
+    obj_entry *e = &entries[i];
+    switch (policy) {
+    case OBJCACHE_S3FIFO:
+        if (e->freq < S3FIFO_MAX_FREQ) {
+            e->freq++;
+        }
+        break;
+    case OBJCACHE_LFU:
+        if (e->freq < LFU_MAX_FREQ) {
+            unlink_entry(i);
+            e->freq++;
+            push(i, e->freq);
+        }
+        break;
+    default:
+        unlink_entry(i);
+        push(i, 0);
+        break;
+    }
+}
+
+
+/* void function, expire a resident object: it leaves the cache, and its key is kept as a tombstone
+ * for a while, so that its next request is counted as an expired miss
+ * @params: unsigned int i: the index of the entry, already off the timer wheel
+ * @return: none
+ */
+static void expire_entry(unsigned int i) {
+
+    stats.expired++;
+    used -= entries[i].size;
+    unlink_entry(i);
+    push(i, QUEUE_EXPIRED);
+
+    // keep about as many tombstones as resident objects
+    unsigned int resident = numKeys - queues[QUEUE_EXPIRED].count -
+                            (policy == OBJCACHE_S3FIFO ? queues[QUEUE_GHOST].count : 0);
+    while (queues[QUEUE_EXPIRED].count > resident + MIN_TOMBSTONES) {
+        unsigned int oldest = queues[QUEUE_EXPIRED].tail;
+        unlink_entry(oldest);
+        free_entry(oldest);
+    }
+}
+
+
+/* void function, move the entries of a slot of the timer wheel one or more levels down,
+ * now that the time reached the span of the slot
+ * @params: int level: the level of the slot, 1 or more
+ * @return: none
+ */
+static void cascade(int level) {
+
+    unsigned int slot = level * WHEEL_SLOTS + ((wheelTime >> (8 * level)) & (WHEEL_SLOTS - 1));
+    unsigned int i = wheel[slot];
+    wheel[slot] = NIL;
+    while (i != NIL) {
+        unsigned int next = entries[i].timerNext;
+        numTimers--;
+        levelTimers[level]--;
+        wheel_add(i);
+        i = next;
+    }
+}
+
+
+/* void function, advance the time of the object cache and expire the objects, see objcache.h
+ */
+extern void objcache_advance(unsigned int now) {
+
+    while (wheelTime < now) {
+
+        // nothing to expire, jump straight to the new time
+        if (numTimers == 0) {
+            wheelTime = now;
+            break;
+        }
+
+        /* with the lower levels empty, no tick before the next span of the lowest level in use expires
+         * or cascades anything, so jump to the tick before that span starts
+         */
+        int level = 0;
+        while (!levelTimers[level]) {
+            level++;
+        }
+        if (level > 0) {
+            unsigned int last = wheelTime | ((1u << (8 * level)) - 1);
+            if (last >= now) {
+                wheelTime = now;
+                break;
+            }
+            wheelTime = last;
+        }
+
+        wheelTime++;
+        if (!(wheelTime & 0xff)) {
+            if (!(wheelTime & 0xffff)) {
+                if (!(wheelTime & 0xffffff)) {
+                    cascade(3);
+                }
+                cascade(2);
+            }
+            cascade(1);
+        }
+
+        // the level 0 slot of this tick holds exactly the entries expiring now
+        unsigned int slot = wheelTime & (WHEEL_SLOTS - 1);
+        while (wheel[slot] != NIL) {
+            unsigned int i = wheel[slot];
+            wheel_remove(i);
+            expire_entry(i);
+        }
+    }
+}
+
+
+/* int function, set up an empty object cache, see objcache.h
+ */
+extern int objcache_init(unsigned long long bytes, int replacement, int admission) {
+
+    objcache_free();
+    capacity = bytes;
+    smallTarget = bytes / 10; // S3-FIFO gives 10% of the capacity to the small FIFO
+    policy = replacement;
+    minFreq = 1;
+
+    maxEntries = 1024;
+    numEntries = 1;
+    bucketMask = 1023;
+    entries = malloc(maxEntries * sizeof(obj_entry));
+    buckets = calloc(bucketMask + 1, sizeof(unsigned int));
+    if (admission && (filter = malloc(tinylfu_size(maxEntries)))) {
+        tinylfu_init(filter, maxEntries);
+    }
+    return entries && buckets && (!admission || filter);
+}
+
+
+/* int function, request an object, see objcache.h
+ */
+extern int objcache_get(unsigned long long key, unsigned int size, unsigned int ttl) {
+
+    stats.refs++;
+    stats.bytes += size;
+    if (filter) {
+        record(key);
+    }
+
+    // only S3-FIFO keeps ghosts, the other policies number their queues over QUEUE_GHOST
+    unsigned int i = find(key);
+    int ghost = i != NIL && policy == OBJCACHE_S3FIFO && entries[i].queue == QUEUE_GHOST;
+    int expired = i != NIL && entries[i].queue == QUEUE_EXPIRED;
+    if (i != NIL && !ghost && !expired) {
+        if (entries[i].size == size) {
+            stats.hits++;
+            touch(i);
+            return 1;
+        }
+        drop(i); // an update, the new version is fetched
+        i = NIL;
+    }
+
+    stats.misses++;
+    stats.byte_misses += size;
+    // a tombstone only counts the first miss after the expiry
+    if (expired) {
+        stats.expired_misses++;
+        unlink_entry(i);
+        free_entry(i);
+        i = NIL;
+    }
+    if (size > capacity) {
+        stats.too_large++;
+        return 0;
+    }
+
+    // a full cache lets the filter choose between the missing object and the next victim
+    if (filter && used + size > capacity && used > 0) {
+        if (!tinylfu_admit(filter, key, entries[next_victim()].key)) {
+            stats.rejected++;
+            return 0;
+        }
+        stats.admitted++;
+    }
+
+    // a ghost hit is admitted straight to the main FIFO, take it off the ghosts before evicting
+    if (ghost) {
+        unlink_entry(i);
+    }
+    while (used + size > capacity) {
+        evict();
+    }
+    if (!ghost && (i = new_entry(key)) == NIL) {
+        return 0;
+    }
+
+    entries[i].size = size;
+    entries[i].freq = 0;
+    entries[i].expire = 0;
+    used += size;
+    if (ttl) {
+        entries[i].expire = wheelTime + ttl >= wheelTime ? wheelTime + ttl : 0xffffffff;
+        wheel_add(i);
+    }
+    switch (policy) {
+    case OBJCACHE_S3FIFO:
+        push(i, ghost ? QUEUE_MAIN : QUEUE_SMALL);
+        break;
+    case OBJCACHE_LFU:
+        entries[i].freq = 1;
+        push(i, 1);
+        minFreq = 1;
+        break;
+    default:
+        push(i, 0);
+        break;
+    }
+    return 0;
+}
+
+
+/* void function, copy the statistics of the object cache, see objcache.h
+ */
+extern void objcache_get_stats(struct objcache_stats *copy) {
+
+    *copy = stats;
+}
+
+
+/* void function, free the metadata of the object cache, see objcache.h
+ */
+extern void objcache_free(void) {
+
+    free(entries);
+    free(buckets);
+    free(filter);
+    entries = 0;
+    buckets = 0;
+    filter = 0;
+    numEntries = maxEntries = freeList = numKeys = 0;
+    used = 0;
+    wheelTime = numTimers = 0;
+    memset(levelTimers, 0, sizeof(levelTimers));
+    memset(queues, 0, sizeof(queues));
+    memset(wheel, 0, sizeof(wheel));
+    memset(&stats, 0, sizeof(stats));
+}
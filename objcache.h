@@ -0,0 +1,65 @@
+#ifndef CACHE_OBJCACHE_H
+#define CACHE_OBJCACHE_H
+
+/* Replacement policies of the object cache */
+#define OBJCACHE_LRU    0
+#define OBJCACHE_S3FIFO 1
+#define OBJCACHE_LFU    2
+
+/* The statistics of the object cache, all 64 bits
+ *   refs, hits, misses: the requests, and how many of them found the object in the cache
+ *   evictions:          the objects evicted to make room
+ *   bytes, byte_misses: the bytes requested, and the bytes of the requests that missed
+ *   too_large:          the misses of objects larger than the whole cache, which are never inserted
+ *   admitted, rejected: the misses the TinyLFU admission filter let in or kept out of a full cache
+ *   expired:            the objects removed because their TTL ran out
+ *   expired_misses:     the misses of keys that had expired (as far as the cache still remembers them)
+ */
+struct objcache_stats {
+    unsigned long long refs;
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions;
+    unsigned long long bytes;
+    unsigned long long byte_misses;
+    unsigned long long too_large;
+    unsigned long long admitted;
+    unsigned long long rejected;
+    unsigned long long expired;
+    unsigned long long expired_misses;
+};
+
+/* Sets up an empty object cache (a key-value cache) holding at most capacity bytes of objects.
+ * The metadata of the cache lives outside of that capacity: it grows with the number of resident
+ * objects, not with the number of distinct keys of the trace.
+ *   capacity:  the capacity of the cache in bytes
+ *   policy:    OBJCACHE_LRU, OBJCACHE_S3FIFO or OBJCACHE_LFU
+ *   admission: 1 to put a TinyLFU admission filter in front of eviction: once the cache is full, a missing
+ *              object is only inserted if it was requested more often recently than the first object it
+ *              would evict
+ * Returns: 1 on success and 0 if the metadata can't be allocated
+ */
+extern int objcache_init(unsigned long long capacity, int policy, int admission);
+
+/* Requests an object, inserting it on a miss and evicting objects until it fits.  A request for a
+ * resident key with a different size is an update: the old object is dropped and it counts as a miss.
+ *   key:  the key of the object
+ *   size: the size of the object in bytes
+ *   ttl:  on a miss, the object expires ttl time units after the current time, 0 for never
+ * Returns: 1 on a hit and 0 on a miss
+ */
+extern int objcache_get(unsigned long long key, unsigned int size, unsigned int ttl);
+
+/* Advances the current time of the object cache and removes the objects that expired up to it.
+ * A timer wheel makes this O(1) amortized per object, however far the time jumps: empty stretches of the
+ * wheel are skipped a span of the lowest level in use at a time.  Time going backwards is ignored.
+ *   now: the time of the next request, in the unit of the TTLs
+ */
+extern void objcache_advance(unsigned int now);
+
+/* Copies the statistics of the object cache into stats. */
+extern void objcache_get_stats(struct objcache_stats *stats);
+
+/* Frees the metadata of the object cache. */
+extern void objcache_free(void);
+#endif //CACHE_OBJCACHE_H
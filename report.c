@@ -0,0 +1,310 @@
+/**
+ * @author hongh233
+ * @description: This C program writes the statistics of a run in a machine-readable form, JSON or CSV,
+ * so results of many runs can be post-processed without parsing the text output.
+ * Every record repeats the configuration of the run, and records are written per interval and at the end.
+ */
+
+#include "report.h"
+#include <stdio.h>
+#include <string.h>
+
+static FILE *output;                          // where the records are written, NULL if not open
+static int outputFormat;                      // REPORT_JSON or REPORT_CSV
+static const struct report_config *runConfig; // the configuration echoed in every record
+
+
+/* double function, compute a rate without dividing by 0
+ * @params: double count: the numerator
+ * @params: double total: the denominator
+ * @return: count / total, or 0 if total is 0
+ */
+static double rate(double count, double total) {
+
+    return total > 0 ? count / total : 0;
+}
+
+
+/* void function, write a string field: a JSON string with its quotes, backslashes and control characters
+ * escaped, or a CSV field, quoted with doubled quotes if it holds a separator, a quote or a line break
+ * @params: const char * text: the string
+ * @return: none
+ */
+static void write_string(const char *text) {
+
+    if (outputFormat == REPORT_CSV) {
+        if (!strpbrk(text, ",\"\r\n")) {
+            fputs(text, output);
+            return;
+        }
+        fputc('"', output);
+        for (; *text; text++) {
+            if (*text == '"') {
+                fputc('"', output);
+            }
+            fputc(*text, output);
+        }
+        fputc('"', output);
+        return;
+    }
+
+    fputc('"', output);
+    for (; *text; text++) {
+        unsigned char c = *text;
+        if (c == '"' || c == '\\') {
+            fprintf(output, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(output, "\\u%04x", c);
+        } else {
+            fputc(c, output);
+        }
+    }
+    fputc('"', output);
+}
+
+
+/* void function, write the configuration of the cache after the sampling parameters: CSV fields, or the
+ * members of the JSON config object
+ * @params: const struct report_config * c: the configuration of the run
+ * @return: none
+ */
+static void write_config(const struct report_config *c) {
+
+    if (outputFormat == REPORT_CSV) {
+        fprintf(output, ",%u,", c->ways);
+        write_string(c->index);
+        fputc(',', output);
+        write_string(c->insertion);
+        fputc(',', output);
+        write_string(c->admission);
+        fputc(',', output);
+        write_string(c->compression);
+        fprintf(output, ",%u,%d,%u,%u,", c->tenants, c->dedup, c->sectors, c->values);
+        write_string(c->memory);
+        if (c->dram) {
+            fprintf(output, ",%u,%u,%u,%u,", c->dram->channels, c->dram->ranks, c->dram->banks, c->dram->queue);
+            write_string(c->page);
+        } else {
+            fputs(",,,,,", output);
+        }
+        return;
+    }
+
+    fprintf(output, ",\"ways\":%u,\"index\":", c->ways);
+    write_string(c->index);
+    fprintf(output, ",\"insertion\":");
+    write_string(c->insertion);
+    fprintf(output, ",\"admission\":");
+    write_string(c->admission);
+    fprintf(output, ",\"compression\":");
+    write_string(c->compression);
+    fprintf(output, ",\"tenants\":%u,\"dedup\":%d,\"sectors\":%u,\"values\":%u,\"memory\":",
+            c->tenants, c->dedup, c->sectors, c->values);
+    write_string(c->memory);
+    if (c->dram) {
+        fprintf(output, ",\"dram\":{\"channels\":%u,\"ranks\":%u,\"banks\":%u,\"queue\":%u,\"page\":",
+                c->dram->channels, c->dram->ranks, c->dram->banks, c->dram->queue);
+        write_string(c->page);
+        fputc('}', output);
+    } else {
+        fprintf(output, ",\"dram\":null");
+    }
+}
+
+
+/* void function, write the DRAM statistics: CSV fields, empty without them, or a JSON member, omitted
+ * without them
+ * @params: const struct dram_stats * dram: the statistics, NULL without a DRAM model
+ * @return: none
+ */
+static void write_dram(const struct dram_stats *dram) {
+
+    if (!dram) {
+        if (outputFormat == REPORT_CSV) {
+            fputs(",,,,,,,,", output);
+        }
+        return;
+    }
+    fprintf(output, outputFormat == REPORT_CSV ? ",%llu,%llu,%llu,%llu,%.1f,%llu,%llu,%llu" :
+                    ",\"dram\":{\"requests\":%llu,\"row_hits\":%llu,\"row_empty\":%llu,\"row_conflicts\":%llu,"
+                    "\"latency_mean\":%.1f,\"latency_max\":%llu,\"stall_cycles\":%llu,\"cycles\":%llu}",
+            dram->requests, dram->row_hits, dram->row_empty, dram->row_conflicts,
+            rate(dram->latency_sum, dram->requests), dram->latency_max, dram->stall_cycles, dram->cycles);
+}
+
+
+/* void function, write the value locality of the blocks filled or hit: CSV fields, empty without it, or a
+ * member of the JSON values object
+ * @params: const char * name: the name of the JSON member, "fills" or "hits"
+ * @params: const struct value_stats * values: the value locality, NULL without the analysis
+ * @return: none
+ */
+static void write_values(const char *name, const struct value_stats *values) {
+
+    if (!values) {
+        if (outputFormat == REPORT_CSV) {
+            fputs(",,,,,,,", output);
+        }
+        return;
+    }
+    if (outputFormat != REPORT_CSV) {
+        fprintf(output, "%s\"%s\":", strcmp(name, "fills") ? "," : "", name);
+    }
+    fprintf(output, outputFormat == REPORT_CSV ? ",%llu,%llu,%llu,%llu,%llu,%llu,%llu" :
+                    "{\"blocks\":%llu,\"zero\":%llu,\"narrow\":%llu,\"repeated\":%llu,\"zero_words\":%llu,"
+                    "\"narrow_words\":%llu,\"repeated_words\":%llu}",
+            values->blocks, values->zero, values->narrow, values->repeated, values->zero_words,
+            values->narrow_words, values->repeated_words);
+}
+
+
+/* void function, write the energy and area estimate: CSV fields, empty without it, or a JSON member, omitted
+ * without it. The energies are in nJ, the energy per access in pJ and the area in mm2
+ * @params: const struct energy_estimate * energy: the estimate, NULL without it
+ * @params: unsigned long long cycles: the cycles of the run the estimate assumed
+ * @return: none
+ */
+static void write_energy(const struct energy_estimate *energy, unsigned long long cycles) {
+
+    if (!energy) {
+        if (outputFormat == REPORT_CSV) {
+            fputs(",,,,,,,,", output);
+        }
+        return;
+    }
+    fprintf(output, outputFormat == REPORT_CSV ? ",%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%llu,%.4f" :
+                    ",\"energy\":{\"tag_nj\":%.3f,\"data_nj\":%.3f,\"leakage_nj\":%.3f,\"dram_nj\":%.3f,"
+                    "\"total_nj\":%.3f,\"per_access_pj\":%.2f,\"cycles\":%llu,\"area_mm2\":%.4f}",
+            energy->tag / 1000, energy->data / 1000, energy->leakage / 1000, energy->dram / 1000,
+            energy->total / 1000, energy->per_access, cycles, energy->area);
+}
+
+
+/* void function, write one record in the output format
+ * @params: const char * type: the type of the record, "interval", "branch" or "summary"
+ * @params: int number: the index of the interval or of the branch, -1 for the summary
+ * @params: const char * policy: the replacement policy of the counters
+ * @params: const struct cache_stats * stats: the counters of the record
+ * @params: unsigned long trace_refs: the number of trace references the record covers
+ * @params: double seconds: the time the record covers
+ * @params: const struct report_results * results: the results of the optional models, NULL for none
+ * @return: none
+ */
+static void write_record(const char *type, int number, const char *policy, const struct cache_stats *stats,
+                         unsigned long trace_refs, double seconds, const struct report_results *results) {
+
+    const struct report_config *c = runConfig;
+    static const struct report_results none;
+    if (!results) {
+        results = &none;
+    }
+
+    if (outputFormat == REPORT_CSV) {
+        fprintf(output, "%s,%d,L1,", type, number);
+        write_string(policy);
+        fprintf(output, ",%u,%u,", c->F_size, c->M_size);
+        write_string(c->warmup);
+        fprintf(output, ",%lu,%lu,%lu", c->interval, c->sample_period, c->sample_unit);
+        write_config(c);
+        fprintf(output, ",%llu,%llu,%llu,%llu,%llu,%.6f,%lu,%.6f,%.1f", stats->refs, stats->hits, stats->misses,
+                stats->fills, stats->evictions, rate(stats->hits, stats->refs), trace_refs, seconds,
+                rate(trace_refs, seconds));
+        write_dram(results->dram);
+        write_values("fills", results->value_fills);
+        write_values("hits", results->value_hits);
+        write_energy(results->energy, results->cycles);
+        fputc('\n', output);
+        return;
+    }
+
+    // one JSON object per line, so records can be streamed and appended
+    fprintf(output, "{\"type\":\"%s\"", type);
+    if (number >= 0) {
+        fprintf(output, ",\"%s\":%d", strcmp(type, "branch") ? "interval" : "branch", number);
+    }
+    fprintf(output, ",\"config\":{\"F_size\":%u,\"M_size\":%u,\"policy\":", c->F_size, c->M_size);
+    write_string(policy);
+    fprintf(output, ",\"warmup\":");
+    write_string(c->warmup);
+    fprintf(output, ",\"interval\":%lu,\"sample_period\":%lu,\"sample_unit\":%lu",
+            c->interval, c->sample_period, c->sample_unit);
+    write_config(c);
+    fprintf(output, "},\"levels\":[{\"level\":\"L1\",\"policy\":");
+    write_string(policy);
+    fprintf(output, ",\"refs\":%llu,\"hits\":%llu,\"misses\":%llu,\"fills\":%llu,\"evictions\":%llu,"
+                    "\"hit_rate\":%.6f}]",
+            stats->refs, stats->hits, stats->misses, stats->fills, stats->evictions, rate(stats->hits, stats->refs));
+    write_dram(results->dram);
+    if (results->value_fills) {
+        fprintf(output, ",\"values\":{");
+        write_values("fills", results->value_fills);
+        write_values("hits", results->value_hits);
+        fputc('}', output);
+    }
+    write_energy(results->energy, results->cycles);
+    fprintf(output, ",\"trace_refs\":%lu,\"seconds\":%.6f,\"refs_per_second\":%.1f}\n",
+            trace_refs, seconds, rate(trace_refs, seconds));
+}
+
+
+/* int function, open the statistics output, see report.h
+ */
+extern int report_open(const char *path, int format, const struct report_config *config) {
+
+    output = strcmp(path, "-") ? fopen(path, "w") : stdout;
+    if (!output) {
+        return 0;
+    }
+    outputFormat = format;
+    runConfig = config;
+
+    if (format == REPORT_CSV) {
+        fprintf(output, "type,interval,level,policy,F_size,M_size,warmup,interval_length,sample_period,sample_unit,"
+                        "ways,index,insertion,admission,compression,tenants,dedup,sectors,values,memory,"
+                        "dram_channels,dram_ranks,dram_banks,dram_queue,page,"
+                        "refs,hits,misses,fills,evictions,hit_rate,trace_refs,seconds,refs_per_second,"
+                        "dram_requests,dram_row_hits,dram_row_empty,dram_row_conflicts,dram_latency_mean,"
+                        "dram_latency_max,dram_stall_cycles,dram_cycles,"
+                        "fill_blocks,fill_zero,fill_narrow,fill_repeated,fill_zero_words,fill_narrow_words,"
+                        "fill_repeated_words,hit_blocks,hit_zero,hit_narrow,hit_repeated,hit_zero_words,"
+                        "hit_narrow_words,hit_repeated_words,energy_tag_nj,energy_data_nj,energy_leakage_nj,"
+                        "energy_dram_nj,energy_total_nj,energy_per_access_pj,energy_cycles,area_mm2\n");
+    }
+    return 1;
+}
+
+
+/* void function, write the record of one interval, see report.h
+ */
+extern void report_interval(int number, const struct cache_stats *stats, double seconds) {
+
+    if (output) {
+        write_record("interval", number, runConfig->policy, stats, stats->refs, seconds, 0);
+    }
+}
+
+
+/* void function, write the record of one branch of a forked run, see report.h
+ */
+extern void report_branch(int number, const char *policy, const struct cache_stats *stats, unsigned long trace_refs,
+                          double seconds) {
+
+    if (output) {
+        write_record("branch", number, policy, stats, trace_refs, seconds, 0);
+    }
+}
+
+
+/* void function, write the summary record and close the output, see report.h
+ */
+extern void report_close(const struct cache_stats *stats, unsigned long trace_refs, double seconds,
+                         const struct report_results *results) {
+
+    if (output) {
+        write_record("summary", -1, runConfig->policy, stats, trace_refs, seconds, results);
+        if (output != stdout) {
+            fclose(output);
+        }
+        output = 0;
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef CACHE_REPORT_H
+#define CACHE_REPORT_H
+
+#include "cache.h"
+#include "dram.h"
+#include "values.h"
+#include "energy.h"
+
+/* Formats of the machine-readable statistics */
+#define REPORT_JSON 0
+#define REPORT_CSV  1
+
+/* The configuration of a run, echoed in every record so each record stands on its own
+ *   F_size, M_size: the fast and main memory sizes
+ *   policy:         the name of the replacement policy
+ *   warmup:         the warmup window in references, or "full"
+ *   interval:       the length of an interval in counted references, 0 for none
+ *   sample_period, sample_unit: the sampling parameters, 0 for a full simulation
+ *   ways:           the lines per set, 0 for a fully associative cache
+ *   index, insertion, admission, compression: the names of the set index function, the insertion policy,
+ *                   the admission filter and the compression
+ *   tenants:        the tenants sharing the cache, 0 for none
+ *   dedup:          1 if the cache is deduplicated
+ *   sectors:        the sectors of a line, 0 for whole lines
+ *   values:         the regions of the value-locality analysis, 0 for none
+ *   memory:         how main memory is filled
+ *   dram:           the geometry of the DRAM, NULL without a DRAM model
+ *   page:           the name of the row-buffer policy of the DRAM
+ */
+struct report_config {
+    unsigned int F_size;
+    unsigned int M_size;
+    const char *policy;
+    const char *warmup;
+    unsigned long interval;
+    unsigned long sample_period;
+    unsigned long sample_unit;
+    unsigned int ways;
+    const char *index;
+    const char *insertion;
+    const char *admission;
+    const char *compression;
+    unsigned int tenants;
+    int dedup;
+    unsigned int sectors;
+    unsigned int values;
+    const char *memory;
+    const struct dram_config *dram;
+    const char *page;
+};
+
+/* The results of the optional models of a run, written in its summary record
+ *   dram:        the DRAM statistics, NULL without a DRAM model
+ *   value_fills, value_hits: the value locality of the blocks filled and of the blocks hit, NULL without it
+ *   energy:      the energy and area estimate, NULL without it
+ *   cycles:      the cycles of the run the energy estimate assumed
+ */
+struct report_results {
+    const struct dram_stats *dram;
+    const struct value_stats *value_fills;
+    const struct value_stats *value_hits;
+    const struct energy_estimate *energy;
+    unsigned long long cycles;
+};
+
+/* Opens the statistics output and writes the CSV header if needed.
+ *   path:   the file to write, "-" for standard output
+ *   format: REPORT_JSON (one JSON object per line) or REPORT_CSV
+ *   config: the configuration of the run, it must stay valid until report_close()
+ * Returns: 1 on success and 0 if the file can't be opened
+ */
+extern int report_open(const char *path, int format, const struct report_config *config);
+
+/* Writes the record of one interval.
+ *   number:  the index of the interval
+ *   stats:   the counters of the interval
+ *   seconds: the time the interval took
+ */
+extern void report_interval(int number, const struct cache_stats *stats, double seconds);
+
+/* Writes the record of one branch of a forked run, in CSV with the branch in the interval column.
+ *   number:     the index of the branch
+ *   policy:     the replacement policy of the branch
+ *   stats:      the counters of the shared prefix and of the branch together
+ *   trace_refs: the number of trace references processed, including those that were not counted
+ *   seconds:    the time the prefix and the branch took
+ */
+extern void report_branch(int number, const char *policy, const struct cache_stats *stats, unsigned long trace_refs,
+                          double seconds);
+
+/* Writes the summary record of the run and closes the output.  For a forked run it holds the shared prefix,
+ * and it is written after the records of the branches.
+ *   stats:      the counters of the run
+ *   trace_refs: the number of trace references processed, including those that were not counted
+ *   seconds:    the time the simulation took
+ *   results:    the results of the DRAM, value-locality and energy models, NULL for none
+ */
+extern void report_close(const struct cache_stats *stats, unsigned long trace_refs, double seconds,
+                         const struct report_results *results);
+#endif //CACHE_REPORT_H
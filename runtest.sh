@@ -6,7 +6,7 @@
 # To run a single test, e.g., 03
 #   ./runtest.sh 03
 
-TESTS="00 01 02 03 04 05 06 07 08 09"
+TESTS="00 01 02 03 04 05 06 07 08 09 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30 31 32 33 34 35 36 37 38 39 40"
 EXE=cachex
 
 if [ -x $EXE ]; then
@@ -0,0 +1,263 @@
+/**
+ * @author hongh233
+ * @description: This C program finds the phases of a reference trace and picks a representative
+ * interval for each phase, so the cache only has to simulate those intervals to estimate the whole trace.
+ * It follows SimPoint: per-interval frequency vectors, random projection and k-means clustering,
+ * with the block ids of the cache in place of basic blocks.
+ */
+
+#include "cache.h"
+#include "simpoint.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define KMEANS_MAX_ITERATIONS 100
+
+static unsigned long intervalLength;         // the references per interval
+static unsigned long numRefs;                // the references added so far
+static double * intervalVectors;             // the vector of each interval, SIMPOINT_DIMS each, NULL before simpoint_init
+static double lastProjection[SIMPOINT_DIMS]; // the projection of the block of the last reference
+static unsigned long lastBlock;              // the block of the last reference, valid once a reference was added
+
+/* unsigned long function, the splitmix64 generator, used both as the random source of the
+ * k-means seeding and to derive the random projection of each block id
+ * @params: unsigned long * state: the generator state, advanced by each call
+ * @return: the next pseudo-random value
+ */
+static unsigned long splitmix(unsigned long *state) {
+
+    unsigned long z = (*state += 0x9e3779b97f4a7c15UL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9UL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebUL;
+    return z ^ (z >> 31);
+}
+
+
+/* void function, compute the random projection of a block id: a fixed pseudo-random vector
+ * with elements in [-1, 1), the same for every occurrence of the block id
+ * @params: unsigned long block: the block id
+ * @params: double projection[SIMPOINT_DIMS]: where the vector is stored
+ * @return: none
+ */
+static void project(unsigned long block, double projection[SIMPOINT_DIMS]) {
+
+    unsigned long state = block;
+    for (int d = 0; d < SIMPOINT_DIMS; d++) {
+        projection[d] = (double)(splitmix(&state) >> 11) / (1UL << 52) - 1.0;
+    }
+}
+
+
+/* double function, the squared euclidean distance between two projected vectors
+ * @params: const double * a: the first vector
+ * @params: const double * b: the second vector
+ * @return: the squared distance
+ */
+static double distance(const double *a, const double *b) {
+
+    double sum = 0;
+    for (int d = 0; d < SIMPOINT_DIMS; d++) {
+        sum += (a[d] - b[d]) * (a[d] - b[d]);
+    }
+    return sum;
+}
+
+
+/* void function, normalize the vector of an interval by the number of its references, so the last, partial
+ * interval is comparable
+ * @params: unsigned long interval: the interval
+ * @params: unsigned long count: the references of the interval
+ * @return: none
+ */
+static void normalize(unsigned long interval, unsigned long count) {
+
+    for (int d = 0; d < SIMPOINT_DIMS; d++) {
+        intervalVectors[interval * SIMPOINT_DIMS + d] /= count;
+    }
+}
+
+
+/* int function, start building the projected block-frequency vectors of the intervals, see simpoint.h
+ */
+extern int simpoint_init(unsigned long num_refs, unsigned long length) {
+
+    unsigned long num_intervals = (num_refs + length - 1) / length;
+    free(intervalVectors);
+    intervalVectors = calloc(num_intervals ? num_intervals * SIMPOINT_DIMS : 1, sizeof(double));
+    intervalLength = length;
+    numRefs = 0;
+    return intervalVectors != 0;
+}
+
+
+/* void function, add the next reference to the vector of its interval, see simpoint.h
+ */
+extern void simpoint_add(unsigned int address) {
+
+    double *vector = intervalVectors + (numRefs / intervalLength) * SIMPOINT_DIMS;
+
+    // consecutive references mostly hit the same block, so reuse its projection
+    unsigned long block = cache_block_id(address);
+    if (!numRefs || block != lastBlock) {
+        project(block, lastProjection);
+        lastBlock = block;
+    }
+    for (int d = 0; d < SIMPOINT_DIMS; d++) {
+        vector[d] += lastProjection[d];
+    }
+
+    // normalize the interval once it is complete
+    if (++numRefs % intervalLength == 0) {
+        normalize(numRefs / intervalLength - 1, intervalLength);
+    }
+}
+
+
+/* void function, seed the centroids with k-means++: the first centroid is a random interval,
+ * each next one is an interval picked with probability proportional to its squared distance
+ * from the closest centroid picked so far
+ * @params: const double * vectors: the interval vectors
+ * @params: unsigned long num_intervals: the number of intervals
+ * @params: int k: the number of centroids
+ * @params: double * centroids: where the centroids are stored
+ * @return: none
+ */
+static void seed_centroids(const double *vectors, unsigned long num_intervals, int k, double *centroids) {
+
+    unsigned long state = 0x5eed;  // fixed, so the same trace always gives the same simpoints
+    double *closest = malloc(num_intervals * sizeof(double));
+    assert(closest);
+
+    unsigned long pick = splitmix(&state) % num_intervals;
+    for (int c = 0; c < k; c++) {
+        memcpy(centroids + c * SIMPOINT_DIMS, vectors + pick * SIMPOINT_DIMS, SIMPOINT_DIMS * sizeof(double));
+
+        // update the distance of every interval to its closest centroid
+        double total = 0;
+        for (unsigned long i = 0; i < num_intervals; i++) {
+            double d = distance(vectors + i * SIMPOINT_DIMS, centroids + c * SIMPOINT_DIMS);
+            if (c == 0 || d < closest[i]) {
+                closest[i] = d;
+            }
+            total += closest[i];
+        }
+
+        // pick the next centroid, all intervals equal to a centroid means any pick will do
+        double target = (double)(splitmix(&state) >> 11) / (1UL << 53) * total;
+        pick = 0;
+        for (unsigned long i = 0; i < num_intervals; i++) {
+            if (closest[i] > 0) {
+                pick = i;
+                if ((target -= closest[i]) < 0) {
+                    break;
+                }
+            }
+        }
+    }
+    free(closest);
+}
+
+
+/* int function, find the phases of the trace added so far and pick the representative interval of each,
+ * see simpoint.h
+ */
+extern int simpoint_select(unsigned long k, struct simpoint *points) {
+
+    unsigned long num_intervals = (numRefs + intervalLength - 1) / intervalLength;
+    if (numRefs % intervalLength) {
+        normalize(num_intervals - 1, numRefs % intervalLength);  // the last interval is partial
+    }
+    if (k > SIMPOINT_MAX_K) {
+        k = SIMPOINT_MAX_K;
+    }
+    if (k > num_intervals) {
+        k = num_intervals;
+    }
+    int clusters = (int) k;  // at most SIMPOINT_MAX_K now
+    if (clusters == 0) {
+        free(intervalVectors);
+        intervalVectors = 0;
+        return 0;
+    }
+
+    int *cluster = calloc(num_intervals, sizeof(int));
+    double centroids[SIMPOINT_MAX_K * SIMPOINT_DIMS];
+    assert(cluster);
+
+    seed_centroids(intervalVectors, num_intervals, clusters, centroids);
+
+    // iterate k-means until no interval changes its cluster
+    for (int iteration = 0; iteration < KMEANS_MAX_ITERATIONS; iteration++) {
+
+        // assign every interval to its closest centroid
+        int changed = 0;
+        for (unsigned long i = 0; i < num_intervals; i++) {
+            int best = 0;
+            double bestDistance = distance(intervalVectors + i * SIMPOINT_DIMS, centroids);
+            for (int c = 1; c < clusters; c++) {
+                double d = distance(intervalVectors + i * SIMPOINT_DIMS, centroids + c * SIMPOINT_DIMS);
+                if (d < bestDistance) {
+                    best = c;
+                    bestDistance = d;
+                }
+            }
+            changed |= cluster[i] != best;
+            cluster[i] = best;
+        }
+        if (!changed && iteration > 0) {
+            break;
+        }
+
+        // move every centroid to the mean of its intervals, an empty cluster keeps its centroid
+        double sums[SIMPOINT_MAX_K * SIMPOINT_DIMS] = {0};
+        unsigned long counts[SIMPOINT_MAX_K] = {0};
+        for (unsigned long i = 0; i < num_intervals; i++) {
+            counts[cluster[i]]++;
+            for (int d = 0; d < SIMPOINT_DIMS; d++) {
+                sums[cluster[i] * SIMPOINT_DIMS + d] += intervalVectors[i * SIMPOINT_DIMS + d];
+            }
+        }
+        for (int c = 0; c < clusters; c++) {
+            if (counts[c]) {
+                for (int d = 0; d < SIMPOINT_DIMS; d++) {
+                    centroids[c * SIMPOINT_DIMS + d] = sums[c * SIMPOINT_DIMS + d] / counts[c];
+                }
+            }
+        }
+    }
+
+    // the representative of each cluster is the interval closest to its centroid
+    unsigned long best[SIMPOINT_MAX_K];
+    double bestDistance[SIMPOINT_MAX_K];
+    unsigned long counts[SIMPOINT_MAX_K] = {0};
+    unsigned long refs[SIMPOINT_MAX_K] = {0};  // the references of the intervals of each cluster
+    for (unsigned long i = 0; i < num_intervals; i++) {
+        int c = cluster[i];
+        double d = distance(intervalVectors + i * SIMPOINT_DIMS, centroids + c * SIMPOINT_DIMS);
+        if (!counts[c] || d < bestDistance[c]) {
+            best[c] = i;
+            bestDistance[c] = d;
+        }
+        counts[c]++;
+        refs[c] += i + 1 < num_intervals || numRefs % intervalLength == 0 ? intervalLength : numRefs % intervalLength;
+    }
+
+    /* store the non-empty clusters' representatives sorted by interval, so they can be simulated in order,
+     * weighted by the references of the cluster, so a partial last interval weighs less than a full one
+     */
+    int num_points = 0;
+    for (unsigned long i = 0; i < num_intervals; i++) {
+        int c = cluster[i];
+        if (best[c] == i) {
+            points[num_points].interval = i;
+            points[num_points].weight = (double)refs[c] / numRefs;
+            num_points++;
+        }
+    }
+
+    free(intervalVectors);
+    intervalVectors = 0;
+    free(cluster);
+    return num_points;
+}
@@ -0,0 +1,42 @@
+#ifndef CACHE_SIMPOINT_H
+#define CACHE_SIMPOINT_H
+
+/* The number of dimensions the block-frequency vectors are randomly projected to before clustering */
+#define SIMPOINT_DIMS 15
+
+/* The maximum number of clusters, and so of representative intervals */
+#define SIMPOINT_MAX_K 64
+
+/* A representative interval of a trace
+ *   interval: the index of the interval, it covers references interval * length .. (interval + 1) * length - 1
+ *   weight:   the fraction of the trace's references in the intervals that behave like this one
+ */
+struct simpoint {
+    unsigned long interval;
+    double weight;
+};
+
+/* Starts finding the phases of a trace (like SimPoint).  The trace is cut into intervals of length
+ * references, and each interval is summarized by the frequency of the block ids (cache_block_id()) it
+ * references, randomly projected to SIMPOINT_DIMS dimensions.  The references are added one at a time
+ * with simpoint_add(), so only the vectors of the intervals are kept, never the trace.
+ *   num_refs: the number of references of the trace
+ *   length:   the number of references per interval
+ * Returns: 1 on success and 0 if the vectors can't be allocated
+ */
+extern int simpoint_init(unsigned long num_refs, unsigned long length);
+
+/* Adds the next reference of the trace to the vector of its interval.
+ *   address: the address of the reference
+ */
+extern void simpoint_add(unsigned int address);
+
+/* Clusters the vectors of the intervals added so far with k-means and picks one representative interval
+ * for each cluster, the interval closest to the cluster's centroid, weighted by the cluster's share of the
+ * references, since the last interval may be partial.  The vectors are freed.
+ *   k:      the number of clusters, at most SIMPOINT_MAX_K
+ *   points: where the representative intervals are stored, sorted by interval, room for k entries
+ * Returns: the number of representative intervals found (less than k if there are fewer intervals)
+ */
+extern int simpoint_select(unsigned long k, struct simpoint *points);
+#endif //CACHE_SIMPOINT_H
@@ -3,7 +3,16 @@
 echo ======================================================
 echo ====================== TEST $1 ========================
 echo ======================================================
-if timeout 10 ./$2/$3 < tests/test.$1.in > tests/test.$1.out; then 
+# the options of a test, if any, are in tests/test.NN.args, and tests/test.NN.setup holds the options of
+# a run on the same trace before the test, for a test that needs what that run writes (a checkpoint)
+ARGS=
+if [ -f tests/test.$1.args ]; then
+  ARGS=`cat tests/test.$1.args`
+fi
+if [ -f tests/test.$1.setup ]; then
+  ./$2/$3 `cat tests/test.$1.setup` < tests/test.$1.in > /dev/null
+fi
+if timeout 10 ./$2/$3 $ARGS < tests/test.$1.in > tests/test.$1.out; then 
   if diff -w tests/test.$1.out tests/test.$1.expected > /dev/null; then
     echo PASSED
   else
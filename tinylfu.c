@@ -0,0 +1,190 @@
+/**
+ * @author hongh233
+ * @description: This C program will implement a TinyLFU admission filter, which lets a cache keep
+ * a block or an object it would otherwise evict for a new one that was accessed less often recently.
+ * Frequencies are estimated with a count-min sketch of 4-bit counters behind a doorkeeper Bloom filter,
+ * and aged by halving, so the whole filter takes a few bytes per cache entry.
+ */
+
+#include "tinylfu.h"
+#include <string.h>
+
+#define ROWS 4           // the rows of the count-min sketch
+#define MAX_COUNT 15     // the 4-bit counters saturate here
+#define SAMPLE_FACTOR 10 // the accesses between two agings, per counter of a row
+
+
+/* unsigned long long function, mix the bits of a key (splitmix64 finalizer), so that keys close
+ * to each other, like consecutive block ids, land on unrelated counters
+ * @params: unsigned long long key: the key
+ * @return: the hash of the key
+ */
+static unsigned long long mix(unsigned long long key) {
+
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+
+/* unsigned int function, get the counter of a key in one row of the sketch
+ * @params: const struct tinylfu * filter: the filter
+ * @params: unsigned long long hash: the hash of the key
+ * @params: int row: the row
+ * @return: the index of the counter in the table, 2 counters per byte
+ */
+static unsigned int counter_of(const struct tinylfu *filter, unsigned long long hash, int row) {
+
+    unsigned int h1 = (unsigned int)hash;
+    unsigned int h2 = (unsigned int)(hash >> 32) | 1;
+    return row * filter->width + ((h1 + row * h2) & (filter->width - 1));
+}
+
+
+/* unsigned int function, read a 4-bit counter
+ * @params: const unsigned char * table: the counters
+ * @params: unsigned int index: the index of the counter
+ * @return: the value of the counter
+ */
+static unsigned int get_counter(const unsigned char *table, unsigned int index) {
+
+    return (table[index >> 1] >> ((index & 1) * 4)) & 0xf;
+}
+
+
+/* unsigned char * function, find the byte and the bit of one of the 2 doorkeeper bits of a key
+ * @params: struct tinylfu * filter: the filter
+ * @params: unsigned long long hash: the hash of the key
+ * @params: int k: which of the 2 bits
+ * @params: unsigned char * bit: where the mask of the bit in the byte is stored
+ * @return: the byte holding the bit
+ */
+static unsigned char *door_bit(const struct tinylfu *filter, unsigned long long hash, int k, unsigned char *bit) {
+
+    unsigned int bits = ROWS * filter->width;
+    unsigned int index = ((unsigned int)(hash >> 32) + k * ((unsigned int)hash | 1)) & (bits - 1);
+    *bit = 1 << (index & 7);
+    return (unsigned char *)filter->table + ROWS * filter->width / 2 + index / 8;
+}
+
+
+/* void function, age the filter: halve every counter and clear the doorkeeper
+ * @params: struct tinylfu * filter: the filter
+ * @return: none
+ */
+static void age(struct tinylfu *filter) {
+
+    unsigned int counterBytes = ROWS * filter->width / 2;
+    for (unsigned int i = 0; i < counterBytes; i++) {
+        filter->table[i] = (filter->table[i] >> 1) & 0x77;
+    }
+    memset(filter->table + counterBytes, 0, ROWS * filter->width / 8);
+    filter->samples /= 2;
+}
+
+
+/* unsigned int function, compute the counters per row for a number of entries
+ * @params: unsigned int entries: the entries of the cache
+ * @return: the smallest power of 2 that is at least entries, at least 16
+ */
+static unsigned int width_for(unsigned int entries) {
+
+    unsigned int width = 16;
+    while (width < entries && width < 0x40000000) {
+        width *= 2;
+    }
+    return width;
+}
+
+
+/* unsigned long function, the bytes a filter takes, see tinylfu.h
+ */
+extern unsigned long tinylfu_size(unsigned int entries) {
+
+    unsigned int width = width_for(entries);
+
+    // 4 rows of 4-bit counters, and one doorkeeper bit per counter
+    return sizeof(struct tinylfu) + ROWS * width / 2 + ROWS * width / 8;
+}
+
+
+/* void function, set up an empty filter, see tinylfu.h
+ */
+extern void tinylfu_init(struct tinylfu *filter, unsigned int entries) {
+
+    memset(filter, 0, tinylfu_size(entries));
+    filter->width = width_for(entries);
+    filter->sample_limit = SAMPLE_FACTOR * filter->width;
+}
+
+
+/* void function, record one access to a key, see tinylfu.h
+ */
+extern void tinylfu_record(struct tinylfu *filter, unsigned long long key) {
+
+    unsigned long long hash = mix(key);
+
+    // the first access only sets the doorkeeper bits
+    unsigned char bit0, bit1;
+    unsigned char *byte0 = door_bit(filter, hash, 0, &bit0);
+    unsigned char *byte1 = door_bit(filter, hash, 1, &bit1);
+    if (!(*byte0 & bit0) || !(*byte1 & bit1)) {
+        *byte0 |= bit0;
+        *byte1 |= bit1;
+    } else {
+        // conservative update: only the smallest counters grow, which keeps the overestimate low
+        unsigned int index[ROWS];
+        unsigned int smallest = MAX_COUNT;
+        for (int row = 0; row < ROWS; row++) {
+            index[row] = counter_of(filter, hash, row);
+            unsigned int count = get_counter(filter->table, index[row]);
+            smallest = count < smallest ? count : smallest;
+        }
+        if (smallest < MAX_COUNT) {
+            for (int row = 0; row < ROWS; row++) {
+                if (get_counter(filter->table, index[row]) == smallest) {
+                    filter->table[index[row] >> 1] += 1 << ((index[row] & 1) * 4);
+                }
+            }
+        }
+    }
+
+    if (++filter->samples >= filter->sample_limit) {
+        age(filter);
+    }
+}
+
+
+/* unsigned int function, estimate the recent accesses to a key, see tinylfu.h
+ */
+extern unsigned int tinylfu_estimate(const struct tinylfu *filter, unsigned long long key) {
+
+    unsigned long long hash = mix(key);
+
+    unsigned char bit0, bit1;
+    unsigned char *byte0 = door_bit(filter, hash, 0, &bit0);
+    unsigned char *byte1 = door_bit(filter, hash, 1, &bit1);
+    if (!(*byte0 & bit0) || !(*byte1 & bit1)) {
+        return 0;
+    }
+
+    unsigned int smallest = MAX_COUNT;
+    for (int row = 0; row < ROWS; row++) {
+        unsigned int count = get_counter(filter->table, counter_of(filter, hash, row));
+        smallest = count < smallest ? count : smallest;
+    }
+    return smallest + 1; // the access the doorkeeper absorbed
+}
+
+
+/* int function, decide whether a candidate may replace a victim, see tinylfu.h
+ */
+extern int tinylfu_admit(struct tinylfu *filter, unsigned long long candidate, unsigned long long victim) {
+
+    if (tinylfu_estimate(filter, candidate) > tinylfu_estimate(filter, victim)) {
+        filter->admitted++;
+        return 1;
+    }
+    filter->rejected++;
+    return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef CACHE_TINYLFU_H
+#define CACHE_TINYLFU_H
+
+/* A TinyLFU admission filter: a count-min sketch of 4-bit counters (4 rows) that estimates how often
+ * each key was accessed recently, and a doorkeeper Bloom filter in front of it that absorbs the first
+ * access of every key, so one-hit wonders never reach the sketch.  Every sample_limit accesses all the
+ * counters are halved and the doorkeeper is cleared (aging), so old popularity fades.
+ * The filter holds no pointers, it can live in F_memory and be checkpointed and forked with the cache.
+ *   width:        the counters per row, a power of 2
+ *   samples:      the accesses recorded since the last aging
+ *   sample_limit: the accesses between two agings
+ *   admitted, rejected: the admission decisions taken so far
+ *   table:        the counters (2 per byte, 4 rows of width), then the doorkeeper (4 * width bits)
+ */
+struct tinylfu {
+    unsigned int width;
+    unsigned int samples;
+    unsigned int sample_limit;
+    unsigned int reserved;
+    unsigned long long admitted;
+    unsigned long long rejected;
+    unsigned char table[];
+};
+
+/* Returns the bytes a filter for a cache of the given number of entries takes, header included. */
+extern unsigned long tinylfu_size(unsigned int entries);
+
+/* Sets up an empty filter in memory of tinylfu_size(entries) bytes. */
+extern void tinylfu_init(struct tinylfu *filter, unsigned int entries);
+
+/* Records one access to a key. */
+extern void tinylfu_record(struct tinylfu *filter, unsigned long long key);
+
+/* Returns the estimated number of recent accesses to a key. */
+extern unsigned int tinylfu_estimate(const struct tinylfu *filter, unsigned long long key);
+
+/* Decides whether a missing key may replace the key the replacement policy wants to evict:
+ * only if the candidate was accessed more often recently.  Counts the decision.
+ *   candidate: the key that missed
+ *   victim:    the key that would be evicted for it
+ * Returns: 1 to admit the candidate and 0 to keep the victim
+ */
+extern int tinylfu_admit(struct tinylfu *filter, unsigned long long candidate, unsigned long long victim);
+#endif //CACHE_TINYLFU_H
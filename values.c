@@ -0,0 +1,114 @@
+/**
+ * @author hongh233
+ * @description: This C program will implement the value-locality analysis of the blocks a cache hands out.
+ * Each block is classified by zero content, narrow values and repeated values in a single pass over its
+ * sixteen 32-bit words, and counted for its region of main memory, for the fills and the hits separately.
+ */
+
+#include "values.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define VALUES_BLOCK 64  // the bytes of a block
+#define VALUES_WORDS 16  // the 32-bit words of a block
+
+static unsigned int numRegions;    // the regions of main memory, 0 before values_init
+static unsigned long regionBytes;  // the bytes of a region
+static struct value_stats * stats; // the statistics of the fills of each region, then those of the hits
+
+
+/* int function, set up the counters of the analysis
+ * @params: unsigned int regions: the regions main memory is split into
+ * @params: unsigned int memory_size: the bytes of main memory
+ * @return: 1 on success and 0 on failure
+ */
+extern int values_init(unsigned int regions, unsigned int memory_size) {
+
+    if (!regions || regions > VALUES_MAX_REGIONS) {
+        return 0;
+    }
+    stats = calloc(2 * regions, sizeof(struct value_stats));
+    if (!stats) {
+        return 0;
+    }
+    numRegions = regions;
+    regionBytes = ((unsigned long) memory_size + regions - 1) / regions;
+    regionBytes = regionBytes ? regionBytes : 1;
+    return 1;
+}
+
+
+/* void function, classify a block and count it for its region
+ * @params: const unsigned char * block: the block
+ * @params: unsigned long address: the address of the first byte of the block
+ * @params: int hit: 1 for a block found in the cache, 0 for a fill
+ * @return: none
+ */
+extern void values_record(const unsigned char *block, unsigned long address, int hit) {
+
+    if (!numRegions) {
+        return;
+    }
+    unsigned int region = address / regionBytes < numRegions ? address / regionBytes : numRegions - 1;
+    struct value_stats * counts = &(stats[hit ? numRegions + region : region]);
+
+    unsigned int words[VALUES_WORDS];
+    memcpy(words, block, VALUES_BLOCK);
+
+    unsigned int zero = 0, narrow = 0, repeated = 0;
+    for (unsigned int i = 0; i < VALUES_WORDS; i++) {
+        zero += words[i] == 0;
+        narrow += words[i] + 0x8000u < 0x10000u;  // a sign-extended 16-bit value
+        for (unsigned int j = 0; j < i; j++) {
+            if (words[j] == words[i]) {
+                repeated++;
+                break;
+            }
+        }
+    }
+
+    // one 8-byte value repeated: every word equals the word two before it
+    int oneValue = 1;
+    for (unsigned int i = 2; i < VALUES_WORDS && oneValue; i++) {
+        oneValue = words[i] == words[i - 2];
+    }
+
+    counts->blocks++;
+    counts->zero += zero == VALUES_WORDS;
+    counts->narrow += narrow == VALUES_WORDS;
+    counts->repeated += oneValue;
+    counts->zero_words += zero;
+    counts->narrow_words += narrow;
+    counts->repeated_words += repeated;
+}
+
+
+/* unsigned long function, copy the statistics of one region
+ * @params: unsigned int region: the region
+ * @params: struct value_stats * fills: where the statistics of the fills are copied to
+ * @params: struct value_stats * hits: where the statistics of the hits are copied to
+ * @return: the first address of the region
+ */
+extern unsigned long values_get(unsigned int region, struct value_stats *fills, struct value_stats *hits) {
+
+    memset(fills, 0, sizeof(*fills));
+    memset(hits, 0, sizeof(*hits));
+    if (region >= numRegions) {
+        return 0;
+    }
+    *fills = stats[region];
+    *hits = stats[numRegions + region];
+    return region * regionBytes;
+}
+
+
+/* void function, set all the statistics to 0
+ * @params: none
+ * @return: none
+ */
+extern void values_reset() {
+
+    if (numRegions) {
+        memset(stats, 0, 2 * numRegions * sizeof(struct value_stats));
+    }
+}
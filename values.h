@@ -0,0 +1,48 @@
+#ifndef CACHE_VALUES_H
+#define CACHE_VALUES_H
+
+/* Value-locality analysis of the blocks a cache hands out.  Every block loaded from main memory (a fill)
+ * and every block found in the cache (a hit) is classified by its contents, per region of main memory,
+ * to tell whether compression or zero-elimination would help a workload:
+ *   zero:     all 64 bytes are 0
+ *   narrow:   every 32-bit word is a sign-extended 16-bit value (zero blocks included)
+ *   repeated: the block is one 8-byte value repeated (zero blocks included)
+ * and the same for its sixteen 32-bit words: zero words, narrow words, and repeated words, which equal an
+ * earlier word of the block.  The counters live outside of the cache, so the analysis doesn't take any of
+ * its fast memory.
+ */
+#define VALUES_MAX_REGIONS 64
+
+/* The value statistics of the fills or the hits of one region
+ *   blocks:                     the blocks classified
+ *   zero, narrow, repeated:     the blocks of each class
+ *   zero_words, narrow_words, repeated_words: the 32-bit words of each class, 16 per block
+ */
+struct value_stats {
+    unsigned long long blocks;
+    unsigned long long zero;
+    unsigned long long narrow;
+    unsigned long long repeated;
+    unsigned long long zero_words;
+    unsigned long long narrow_words;
+    unsigned long long repeated_words;
+};
+
+/* Sets up the analysis of a main memory of memory_size bytes split into regions equal regions
+ * (1 to VALUES_MAX_REGIONS).  Returns 1 on success and 0 if the counters can't be allocated.
+ */
+extern int values_init(unsigned int regions, unsigned int memory_size);
+
+/* Classifies the 64-byte block at address: hit is 1 for a block found in the cache, 0 for a fill.
+ * Does nothing before values_init().
+ */
+extern void values_record(const unsigned char *block, unsigned long address, int hit);
+
+/* Copies the statistics of the fills and of the hits of one region.
+ * Returns the first address of the region, the region ends where the next one starts.
+ */
+extern unsigned long values_get(unsigned int region, struct value_stats *fills, struct value_stats *hits);
+
+/* Sets all the statistics to 0, e.g. at the end of a warmup window. */
+extern void values_reset(void);
+#endif //CACHE_VALUES_H